@@ -8,13 +8,436 @@
 ***************************************************************************************************************************************************************
 */
 #include "adsvel_log.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include "details/crash_writer.h"
+#include "details/dedicated_sink.h"
+
+namespace {
+#if defined(__unix__) || defined(__APPLE__)
+    // State of the crash handler, only written by InstallCrashHandler() under Logger::mut_.
+    constexpr int kFatalSignals[]{SIGSEGV, SIGABRT, SIGBUS, SIGFPE};
+    struct sigaction previous_actions[std::size(kFatalSignals)];
+    bool crash_handler_installed{false};
+    char crash_file[4096]{};
+    std::unique_ptr<char[]> alternate_stack{};
+    std::atomic<bool> crash_in_progress{false};
+    alignas(adsvel::log::LogRecord) unsigned char crash_record_storage[sizeof(adsvel::log::LogRecord)];
+#endif
+
+    std::string_view Trim(std::string_view in_text) {
+        auto begin{in_text.find_first_not_of(" \t\r")};
+        if (begin == std::string_view::npos) return {};
+        return in_text.substr(begin, in_text.find_last_not_of(" \t\r") - begin + 1);
+    }
+
+    bool EqualNoCase(std::string_view in_a, std::string_view in_b) {
+        return in_a.size() == in_b.size() && std::equal(in_a.begin(), in_a.end(), in_b.begin(), [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b)); });
+    }
+
+    std::vector<std::string> SplitList(std::string_view in_text) {
+        std::vector<std::string> items;
+        while (!in_text.empty()) {
+            auto comma{in_text.find(',')};
+            auto item{Trim(in_text.substr(0, comma))};
+            if (!item.empty()) items.emplace_back(item);
+            if (comma == std::string_view::npos) break;
+            in_text.remove_prefix(comma + 1);
+        }
+        return items;
+    }
+
+    // Modification time of the config file of Logger::SetConfigReload(), only used by the logger thread.
+    std::filesystem::file_time_type config_time{};
+    std::chrono::steady_clock::time_point next_config_check{};
+}  // namespace
 
 //const std::array<std::string_view, static_cast<int>(adsvel::log::LogLevels::_EnumEndDontUseThis_)> adsvel::log::LogLevelsStr{};
 std::vector<std::unique_ptr<adsvel::log::BaseSink>> adsvel::log::Logger::sinks_{};
-std::vector<adsvel::log::LogMessage> adsvel::log::Logger::messages_{};
+std::vector<std::shared_ptr<adsvel::log::details::SinkCounters>> adsvel::log::Logger::sinks_counters_{};
+std::vector<std::string> adsvel::log::Logger::sinks_names_{};
+std::vector<std::shared_ptr<adsvel::log::details::SinkCounters>> adsvel::log::Logger::stats_counters_{};
+std::mutex adsvel::log::Logger::stats_mut_{};
+std::atomic<adsvel::log::details::MpmcQueue<adsvel::log::LogRecord>*> adsvel::log::Logger::queue_{nullptr};
+std::unique_ptr<adsvel::log::details::MpmcQueue<adsvel::log::LogRecord>> adsvel::log::Logger::queue_storage_{};
 std::chrono::steady_clock::duration adsvel::log::Logger::log_interval_{std::chrono::milliseconds(500)};
-std::atomic<adsvel::log::LogLevels> adsvel::log::Logger::log_level_ {adsvel::log::LogLevels::Off};
+adsvel::log::Logger::LevelMasks adsvel::log::Logger::level_masks_{};
+adsvel::log::LogLevels adsvel::log::Logger::level_{adsvel::log::LogLevels::Debug};
+std::deque<adsvel::log::ModuleLogger> adsvel::log::Logger::modules_{};
+std::string adsvel::log::Logger::config_path_{};
+std::chrono::steady_clock::duration adsvel::log::Logger::config_reload_period_{0};
 std::mutex adsvel::log::Logger::mut_{};
+std::atomic<adsvel::log::QueueFullPolicy> adsvel::log::Logger::queue_full_policy_{adsvel::log::QueueFullPolicy::Block};
+std::atomic<size_t> adsvel::log::Logger::queue_high_water_mark_{0};
+std::atomic<double> adsvel::log::Logger::enqueue_rate_{0};
+std::chrono::steady_clock::duration adsvel::log::Logger::metrics_dump_period_{0};
+adsvel::log::LogLevels adsvel::log::Logger::metrics_dump_level_{adsvel::log::LogLevels::Info};
+std::atomic<bool> adsvel::log::Logger::consumer_running_{false};
+std::atomic<bool> adsvel::log::Logger::deferred_formatting_{false};
+std::atomic<bool> adsvel::log::Logger::collapse_duplicates_{false};
+std::atomic<bool> adsvel::log::Logger::stop_requested_{false};
+std::atomic<bool> adsvel::log::Logger::wake_requested_{false};
+std::atomic<bool> adsvel::log::Logger::consumer_parked_{false};
+std::atomic<size_t> adsvel::log::Logger::high_water_mark_{adsvel::log::WakeupPolicy{}.high_water_mark};
+std::atomic<adsvel::log::LogLevels> adsvel::log::Logger::wake_level_{adsvel::log::WakeupPolicy{}.wake_level};
+std::chrono::microseconds adsvel::log::Logger::spin_time_{adsvel::log::WakeupPolicy{}.spin_time};
+std::mutex adsvel::log::Logger::wake_mut_{};
+std::condition_variable adsvel::log::Logger::wake_cv_{};
+std::mutex adsvel::log::Logger::space_mut_{};
+std::condition_variable adsvel::log::Logger::space_cv_{};
+std::atomic<uint32_t> adsvel::log::Logger::blocked_producers_{0};
+bool adsvel::log::Logger::exit_handler_registered_{false};
 std::thread* adsvel::log::Logger::th_{nullptr};
+std::atomic<adsvel::log::ClockSource> adsvel::log::details::LogClock::source_{adsvel::log::ClockSource::System};
+std::atomic<bool> adsvel::log::details::LogClock::use_tsc_{false};
+std::mutex adsvel::log::details::LogClock::mut_{};
+std::atomic<uint32_t> adsvel::log::details::LogClock::sequence_{0};
+std::atomic<int64_t> adsvel::log::details::LogClock::base_ticks_{0};
+std::atomic<int64_t> adsvel::log::details::LogClock::base_ns_{0};
+std::atomic<double> adsvel::log::details::LogClock::ns_per_tick_{1.0};
+int64_t adsvel::log::details::LogClock::anchor_ticks_{0};
+int64_t adsvel::log::details::LogClock::anchor_ns_{0};
+std::chrono::steady_clock::time_point adsvel::log::details::LogClock::last_calibration_{};
+std::mutex adsvel::log::details::ThreadCountersRegistry::mut_{};
+std::vector<std::shared_ptr<adsvel::log::details::ThreadCounters>> adsvel::log::details::ThreadCountersRegistry::threads_{};
+adsvel::log::details::ThreadCountersRegistry::Totals adsvel::log::details::ThreadCountersRegistry::retired_{};
+
+void adsvel::log::Logger::AddSink(std::unique_ptr<BaseSink> in_sink, const SinkOptions& in_options) {
+    auto counters{std::make_shared<details::SinkCounters>()};
+    counters->dispatch = in_options.dispatch;
+    counters->io = &in_sink->GetIoCounters();
+    if (in_options.dispatch == SinkDispatch::Dedicated) in_sink = std::make_unique<details::DedicatedSink>(std::move(in_sink), in_options, counters);
+    {
+        std::lock_guard lock(mut_);
+        if (sinks_.size() == kMaxSinks) throw std::length_error("Too many sinks.");
+        auto name{in_options.name.empty() ? fmt::format("sink{}", sinks_.size()) : in_options.name};
+        if (std::find(sinks_names_.begin(), sinks_names_.end(), name) != sinks_names_.end()) throw std::invalid_argument("Duplicate sink name " + name + ".");
+        sinks_.push_back(std::move(in_sink));
+        sinks_counters_.push_back(counters);
+        sinks_names_.push_back(std::move(name));
+        UpdateLevelMasks_();
+    }
+    std::lock_guard lock(stats_mut_);
+    stats_counters_.push_back(std::move(counters));
+}
+
+std::vector<adsvel::log::SinkStats> adsvel::log::Logger::GetSinksStats() {
+    std::lock_guard lock(stats_mut_);
+    std::vector<SinkStats> stats;
+    stats.reserve(stats_counters_.size());
+    for (auto& counters : stats_counters_) {
+        SinkStats sink_stats;
+        sink_stats.dispatch = counters->dispatch;
+        sink_stats.queue_depth = counters->queue_depth.load(std::memory_order_relaxed);
+        sink_stats.last_flush_latency = std::chrono::nanoseconds{counters->last_flush_latency_ns.load(std::memory_order_relaxed)};
+        sink_stats.dropped = counters->dropped.load(std::memory_order_relaxed);
+        sink_stats.logged = counters->logged.load(std::memory_order_relaxed);
+        sink_stats.log_latency = counters->log_latency.Snapshot();
+        sink_stats.flush_latency = counters->flush_latency.Snapshot();
+        sink_stats.bytes_written = counters->io->bytes_written.load(std::memory_order_relaxed);
+        sink_stats.rotations = counters->io->rotations.load(std::memory_order_relaxed);
+        sink_stats.open_attempts = counters->io->open_attempts.load(std::memory_order_relaxed);
+        sink_stats.sink_dropped = counters->io->dropped.load(std::memory_order_relaxed);
+        stats.push_back(sink_stats);
+    }
+    return stats;
+}
+
+void adsvel::log::Logger::WaitDedicatedSinks_() {
+    std::lock_guard lock(mut_);
+    for (auto& sink : sinks_) {
+        if (auto dedicated = dynamic_cast<details::DedicatedSink*>(sink.get())) dedicated->WaitIdle();
+    }
+}
+
+adsvel::log::details::MpmcQueue<adsvel::log::LogRecord>& adsvel::log::Logger::CreateQueue_(size_t in_capacity) {
+    // Not mut_: a sink may log while the logger thread holds it.
+    static std::mutex create_mut;
+    std::lock_guard lock(create_mut);
+    if (auto queue{queue_.load(std::memory_order_acquire)}) return *queue;
+    queue_storage_ = std::make_unique<details::MpmcQueue<LogRecord>>(in_capacity);
+    queue_.store(queue_storage_.get(), std::memory_order_release);
+    return *queue_storage_;
+}
+
+adsvel::log::LoggerMetrics adsvel::log::Logger::GetMetrics() {
+    LoggerMetrics metrics;
+    metrics.time = std::chrono::system_clock::now();
+    auto totals{details::ThreadCountersRegistry::Sum()};
+    metrics.enqueued = totals.enqueued;
+    metrics.dropped = totals.dropped;
+    metrics.enqueue_rate = enqueue_rate_.load(std::memory_order_relaxed);
+    if (auto queue{queue_.load(std::memory_order_acquire)}) {
+        metrics.queue_depth = queue->SizeApprox();
+        metrics.queue_capacity = queue->Capacity();
+    }
+    metrics.queue_high_water_mark = queue_high_water_mark_.load(std::memory_order_relaxed);
+    metrics.sinks = GetSinksStats();
+    return metrics;
+}
+
+void adsvel::log::Logger::UpdateRate_() {
+    // Only the logger thread calls it.
+    static auto window_start{std::chrono::steady_clock::now()};
+    static uint64_t window_enqueued{0};
+    auto now{std::chrono::steady_clock::now()};
+    std::chrono::duration<double> elapsed{now - window_start};
+    if (elapsed < std::chrono::seconds(1)) return;
+    auto enqueued{details::ThreadCountersRegistry::Sum().enqueued};
+    enqueue_rate_.store(static_cast<double>(enqueued - window_enqueued) / elapsed.count(), std::memory_order_relaxed);
+    window_start = now;
+    window_enqueued = enqueued;
+}
+
+std::string adsvel::log::LoggerMetrics::ToString() const {
+    fmt::memory_buffer out;
+    fmt::format_to(std::back_inserter(out), "metrics: enqueued={} rate={:.0f}/s dropped={} queue={}/{} hwm={}", enqueued, enqueue_rate, dropped, queue_depth, queue_capacity, queue_high_water_mark);
+    for (size_t i{0}; i < sinks.size(); i++) {
+        auto& sink{sinks[i]};
+        fmt::format_to(std::back_inserter(out), "; sink{}: logged={} dropped={} queue={} log_p99={}ns flush_p99={}ns flush_max={}ns bytes={} rotations={} opens={} sink_dropped={}", i, sink.logged, sink.dropped, sink.queue_depth,
+                       sink.log_latency.Percentile(0.99).count(), sink.flush_latency.Percentile(0.99).count(), sink.flush_latency.max.count(), sink.bytes_written, sink.rotations, sink.open_attempts, sink.sink_dropped);
+    }
+    return fmt::to_string(out);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+void adsvel::log::Logger::InstallCrashHandler(const std::string& in_crash_file) {
+    std::lock_guard lock(mut_);
+    if (in_crash_file.size() >= sizeof(crash_file)) throw std::length_error("The crash file path is too long.");
+    std::memcpy(crash_file, in_crash_file.c_str(), in_crash_file.size() + 1);
+    if (crash_handler_installed) return;
+    // A stack overflow can only be reported from an alternate stack. It is set for the calling thread, usually the main one.
+    size_t stack_size{std::max<size_t>(SIGSTKSZ, 64 * 1024)};
+    alternate_stack.reset(new char[stack_size]);
+    stack_t stack{};
+    stack.ss_sp = alternate_stack.get();
+    stack.ss_size = stack_size;
+    sigaltstack(&stack, nullptr);
+    struct sigaction action {};
+    action.sa_handler = OnFatalSignal_;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_ONSTACK;
+    for (size_t i{0}; i < std::size(kFatalSignals); i++) sigaction(kFatalSignals[i], &action, &previous_actions[i]);
+    crash_handler_installed = true;
+}
+
+void adsvel::log::Logger::OnFatalSignal_(int in_signal) {
+    // Async-signal-safe calls only. The logger thread and the sinks may be in any state, everything is best effort.
+    if (!crash_in_progress.exchange(true)) {
+        int fd{crash_file[0] != '\0' ? open(crash_file, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644) : -1};
+        if (fd < 0) fd = STDERR_FILENO;
+        {
+            details::CrashWriter writer{fd};
+            writer.Append("=========================== CRASH: SIGNAL ").Append(static_cast<uint64_t>(in_signal)).Append(" ===========================\n");
+            auto queue{queue_.load(std::memory_order_acquire)};
+            while (queue != nullptr) {
+                // A fresh record for every pop: its empty string is replaced, never freed.
+                auto record{new (crash_record_storage) LogRecord};
+                if (!queue->TryPop(*record)) break;
+                auto level{LogLevelsStr[static_cast<size_t>(record->level) % LogLevelsStr.size()]};
+                if (record->deferred) {
+                    writer.DeferredLine(record->time, level, record->format, record->args.data(), record->args_size);
+                } else {
+                    writer.Line(record->time, level, record->Text());
+                }
+            }
+        }
+        for (auto& sink : sinks_) sink->FlushOnCrash(fd);
+        if (fd != STDERR_FILENO) close(fd);
+    }
+    for (size_t i{0}; i < std::size(kFatalSignals); i++) {
+        if (kFatalSignals[i] == in_signal) sigaction(in_signal, &previous_actions[i], nullptr);
+    }
+    raise(in_signal);
+}
+#else
+void adsvel::log::Logger::InstallCrashHandler(const std::string& in_crash_file) {
+    (void)in_crash_file;  // No POSIX signals, there is nothing to install.
+}
+#endif
+
+std::optional<adsvel::log::LogLevels> adsvel::log::ParseLogLevel(std::string_view in_text) {
+    for (size_t i{0}; i < LogLevelsStr.size(); i++) {
+        if (EqualNoCase(in_text, LogLevelsStr[i])) return static_cast<LogLevels>(i);
+    }
+    if (EqualNoCase(in_text, "Warning")) return LogLevels::Warning;
+    if (EqualNoCase(in_text, "Critical")) return LogLevels::Critical;
+    return std::nullopt;
+}
+
+void adsvel::log::Logger::UpdateLevelMasks_(LevelMasks& out_masks, LogLevels in_level, uint64_t in_route) {
+    for (size_t level{0}; level < kLevelsCount; level++) {
+        uint64_t mask{0};
+        if (static_cast<LogLevels>(level) >= in_level && static_cast<LogLevels>(level) != LogLevels::Off) {
+            for (size_t i{0}; i < sinks_.size(); i++) {
+                if ((in_route >> i & 1) != 0 && sinks_[i]->GetLevel() <= static_cast<LogLevels>(level)) mask |= uint64_t{1} << i;
+            }
+        }
+        out_masks[level].store(mask, std::memory_order_relaxed);
+    }
+}
+
+void adsvel::log::Logger::UpdateLevelMasks_() {
+    UpdateLevelMasks_(level_masks_, level_, ~uint64_t{0});
+    for (auto& module : modules_) UpdateLevelMasks_(module.level_masks_, module.level_, module.route_.load(std::memory_order_relaxed));
+}
+
+adsvel::log::ModuleLogger& adsvel::log::Logger::GetModule(std::string_view in_name) {
+    std::lock_guard lock(mut_);
+    return FindOrAddModule_(in_name);
+}
+
+adsvel::log::ModuleLogger& adsvel::log::Logger::FindOrAddModule_(std::string_view in_name) {
+    for (auto& module : modules_) {
+        if (module.name_ == in_name) return module;
+    }
+    auto& module{modules_.emplace_back(std::string(in_name), level_)};
+    UpdateLevelMasks_(module.level_masks_, module.level_, module.route_.load(std::memory_order_relaxed));
+    return module;
+}
+
+void adsvel::log::Logger::SetLevel(LogLevels in_level) {
+    std::lock_guard lock(mut_);
+    level_ = in_level;
+    UpdateLevelMasks_(level_masks_, level_, ~uint64_t{0});
+}
+
+adsvel::log::LogLevels adsvel::log::Logger::GetLevel() {
+    std::lock_guard lock(mut_);
+    return level_;
+}
+
+bool adsvel::log::Logger::SetSinkLevel(std::string_view in_sink_name, LogLevels in_level) {
+    std::lock_guard lock(mut_);
+    auto it{std::find(sinks_names_.begin(), sinks_names_.end(), in_sink_name)};
+    if (it == sinks_names_.end()) return false;
+    sinks_[static_cast<size_t>(it - sinks_names_.begin())]->SetLevel(in_level);
+    UpdateLevelMasks_();
+    return true;
+}
+
+adsvel::log::LogLevels adsvel::log::ModuleLogger::GetLevel() const {
+    std::lock_guard lock(Logger::mut_);
+    return level_;
+}
+
+void adsvel::log::ModuleLogger::SetLevel(LogLevels in_level) {
+    std::lock_guard lock(Logger::mut_);
+    level_ = in_level;
+    Logger::UpdateLevelMasks_(level_masks_, level_, route_.load(std::memory_order_relaxed));
+}
+
+void adsvel::log::ModuleLogger::SetSinks(const std::vector<std::string>& in_sink_names) {
+    std::lock_guard lock(Logger::mut_);
+    uint64_t route{in_sink_names.empty() ? ~uint64_t{0} : 0};
+    for (auto& name : in_sink_names) {
+        auto it{std::find(Logger::sinks_names_.begin(), Logger::sinks_names_.end(), name)};
+        if (it == Logger::sinks_names_.end()) throw std::invalid_argument("Unknown sink " + name + ".");
+        route |= uint64_t{1} << (it - Logger::sinks_names_.begin());
+    }
+    route_.store(route, std::memory_order_relaxed);
+    Logger::UpdateLevelMasks_(level_masks_, level_, route);
+}
+
+void adsvel::log::Logger::LoadConfig(const std::string& in_path) {
+    std::ifstream file(in_path);
+    if (!file) throw std::runtime_error("Can't open " + in_path + ".");
+    // Everything is parsed before anything is applied, a broken file leaves the settings as they were.
+    std::optional<LogLevels> level;
+    std::vector<std::pair<std::string, LogLevels>> module_levels;
+    std::vector<std::pair<std::string, std::vector<std::string>>> module_sinks;
+    std::vector<std::pair<std::string, LogLevels>> sink_levels;
+    std::string line;
+    for (size_t line_number{1}; std::getline(file, line); line_number++) {
+        auto error = [&](const std::string& in_what) { return std::runtime_error(fmt::format("{}:{}: {}", in_path, line_number, in_what)); };
+        std::string_view text{line};
+        text = Trim(text.substr(0, text.find('#')));
+        if (text.empty()) continue;
+        auto equal{text.find('=')};
+        if (equal == std::string_view::npos) throw error("expected \"key = value\".");
+        auto key{Trim(text.substr(0, equal))};
+        auto value{Trim(text.substr(equal + 1))};
+        if (key.empty()) throw error("empty key.");
+        constexpr std::string_view kSinksSuffix{".sinks"};
+        constexpr std::string_view kSinkPrefix{"sink."};
+        if (key.size() > kSinksSuffix.size() && key.substr(key.size() - kSinksSuffix.size()) == kSinksSuffix) {
+            auto names{SplitList(value)};
+            if (names.size() == 1 && names[0] == "*") names.clear();
+            if (names.empty() && value != "*") throw error("no sinks, use \"*\" for all of them.");
+            module_sinks.emplace_back(std::string(key.substr(0, key.size() - kSinksSuffix.size())), std::move(names));
+            continue;
+        }
+        auto parsed{ParseLogLevel(value)};
+        if (!parsed) throw error("unknown level \"" + std::string(value) + "\".");
+        if (key == "default") {
+            level = parsed;
+        } else if (key.size() > kSinkPrefix.size() && key.substr(0, kSinkPrefix.size()) == kSinkPrefix) {
+            sink_levels.emplace_back(std::string(key.substr(kSinkPrefix.size())), *parsed);
+        } else {
+            module_levels.emplace_back(std::string(key), *parsed);
+        }
+    }
+
+    std::lock_guard lock(mut_);
+    std::vector<uint64_t> routes;
+    for (auto& [name, sinks] : module_sinks) {
+        uint64_t route{sinks.empty() ? ~uint64_t{0} : 0};
+        for (auto& sink : sinks) {
+            auto it{std::find(sinks_names_.begin(), sinks_names_.end(), sink)};
+            if (it == sinks_names_.end()) throw std::runtime_error(in_path + ": unknown sink " + sink + " for " + name + ".");
+            route |= uint64_t{1} << (it - sinks_names_.begin());
+        }
+        routes.push_back(route);
+    }
+    std::vector<BaseSink*> sinks;
+    for (auto& [name, sink_level] : sink_levels) {
+        auto it{std::find(sinks_names_.begin(), sinks_names_.end(), name)};
+        if (it == sinks_names_.end()) throw std::runtime_error(in_path + ": unknown sink " + name + ".");
+        sinks.push_back(sinks_[static_cast<size_t>(it - sinks_names_.begin())].get());
+    }
+
+    // Validated, from here on nothing throws except a failed allocation. Modules are only created now, a rejected file leaves none behind.
+    std::vector<ModuleLogger*> modules;
+    for (auto& [name, module_level] : module_levels) modules.push_back(&FindOrAddModule_(name));
+    for (auto& [name, module_sinks_names] : module_sinks) modules.push_back(&FindOrAddModule_(name));
+    if (level) level_ = *level;
+    for (size_t i{0}; i < module_levels.size(); i++) modules[i]->level_ = module_levels[i].second;
+    for (size_t i{0}; i < routes.size(); i++) modules[module_levels.size() + i]->route_.store(routes[i], std::memory_order_relaxed);
+    for (size_t i{0}; i < sinks.size(); i++) sinks[i]->SetLevel(sink_levels[i].second);
+    UpdateLevelMasks_();
+}
 
+void adsvel::log::Logger::SetConfigReload(const std::string& in_path, std::chrono::steady_clock::duration in_period) {
+    std::lock_guard lock(mut_);
+    config_path_ = in_path;
+    config_reload_period_ = in_period;
+}
 
+void adsvel::log::Logger::ReloadConfigIfChanged_(std::vector<LogMessage>& out_batch) {
+    // Only the logger thread calls it.
+    std::string path;
+    {
+        std::lock_guard lock(mut_);
+        if (config_path_.empty() || config_reload_period_.count() <= 0 || std::chrono::steady_clock::now() < next_config_check) return;
+        next_config_check = std::chrono::steady_clock::now() + config_reload_period_;
+        path = config_path_;
+    }
+    std::error_code ec;
+    auto time{std::filesystem::last_write_time(path, ec)};
+    if (ec || time == config_time) return;
+    config_time = time;
+    try {
+        LoadConfig(path);
+    } catch (const std::exception& e) {
+        out_batch.emplace_back(LogLevels::Error, fmt::format("Failed to reload the log config: {}", e.what()), details::LogClock::Now());
+    }
+}
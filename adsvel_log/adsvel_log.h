@@ -17,71 +17,396 @@
 ***************************************************************************************************************************************************************
 */
 #pragma once
+#include <fmt/compile.h>
 #include <fmt/format.h>
 #include <array>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <string>
 #include <thread>
 #include <vector>
+#include "details/deferred_args.h"
+#include "details/fields.h"
+#include "details/log_clock.h"
+#include "details/metrics.h"
+#include "details/mpmc_queue.h"
+#include "details/rate_limit.h"
+#include "details/span.h"
+#include "details/timestamp_formatter.h"
+
+// Numeric values of LogLevels for the preprocessor.
+#define ADSVEL_LOG_LEVEL_DEBUG 0
+#define ADSVEL_LOG_LEVEL_TRACE 1
+#define ADSVEL_LOG_LEVEL_INFO 2
+#define ADSVEL_LOG_LEVEL_WARNING 3
+#define ADSVEL_LOG_LEVEL_ERROR 4
+#define ADSVEL_LOG_LEVEL_CRITICAL 5
+#define ADSVEL_LOG_LEVEL_OFF 6
+
+#ifndef ADSVEL_LOG_ACTIVE_LEVEL
+#define ADSVEL_LOG_ACTIVE_LEVEL ADSVEL_LOG_LEVEL_DEBUG  ///< Statements below this level are removed at compile time.
+#endif
+
 namespace adsvel::log {
     enum class LogLevels : uint8_t { Debug, Trace, Info, Warning, Error, Critical, Off, _EnumEndDontUseThis_ };
     const std::array<std::string_view, static_cast<int>(LogLevels::_EnumEndDontUseThis_)> LogLevelsStr{"Debug", "Trace", "Info", "Warnng", "Error", "Critic", "Off"};
+    constexpr size_t kLevelsCount{static_cast<size_t>(LogLevels::_EnumEndDontUseThis_)};
+    constexpr LogLevels kActiveLevel{static_cast<LogLevels>(ADSVEL_LOG_ACTIVE_LEVEL)};  ///< Compile-time minimum level, see ADSVEL_LOG_ACTIVE_LEVEL.
+    constexpr size_t kDefaultQueueCapacity{65536};                                      ///< LogRecord slots of the logger queue, see Logger::Initialize().
+    static_assert(static_cast<int>(LogLevels::Off) == ADSVEL_LOG_LEVEL_OFF, "ADSVEL_LOG_LEVEL_* must follow LogLevels.");
+    /// Accepts the LogLevelsStr names and the full ones ("Warning", "Critical"), case-insensitive.
+    std::optional<LogLevels> ParseLogLevel(std::string_view in_text);
+
+    /// What Logger::Log does when the queue between the producers and the logger thread is full.
+    enum class QueueFullPolicy : uint8_t {
+        /// Wait until the logger thread frees a slot (drops only while the logger thread isn't running). For the queue of a dedicated sink
+        /// it is the logger thread that waits, every other sink stalls until the slow one catches up.
+        Block,
+        DropNewest,      ///< Discard the message being logged.
+        OverwriteOldest  ///< Discard the oldest queued message to make room for the new one.
+    };
 
     class LogMessage {
        public:
+        LogMessage() = default;
         LogMessage(LogLevels in_level, std::string in_message) : message(in_message), time(std::chrono::system_clock::now()), level(in_level) {}
-        std::string message;
-        std::chrono::system_clock::time_point time;
-        LogLevels level;
+        LogMessage(LogLevels in_level, std::string in_message, std::chrono::system_clock::time_point in_time) : message(std::move(in_message)), time(in_time), level(in_level) {}
+        std::string message{};
+        std::chrono::system_clock::time_point time{};
+        LogLevels level{LogLevels::Info};
+        std::string_view format{};  ///< Format string of a deferred message, empty for messages formatted by the caller.
+        std::string args{};         ///< Arguments of a deferred message in the details::EncodeArgs() encoding.
+        std::string fields{};       ///< Structured fields in the details::EncodeFields() encoding, read them with details::ForEachField().
+        SourceLocation location{};  ///< Set by the ADSVEL_LOG_* macros and LogKv(), empty otherwise.
+        uint64_t thread_id{0};      ///< Of the thread that logged the message, see details::CurrentThreadId().
+    };
+
+    /// A message on its way through the logger queue. A deferred record carries the format string and the encoded arguments instead of the text,
+    /// the text is built by the logger thread in ToMessage().
+    class LogRecord {
+       public:
+        LogRecord() {}  // args stays uninitialized on purpose, only the first args_size bytes are ever read.
+        LogRecord(LogRecord&& in_other) noexcept { *this = std::move(in_other); }
+        LogRecord& operator=(LogRecord&& in_other) noexcept {
+            time = in_other.time;
+            message = std::move(in_other.message);
+            format = in_other.format;
+            args_size = in_other.args_size;
+            level = in_other.level;
+            deferred = in_other.deferred;
+            sinks = in_other.sinks;
+            location = in_other.location;
+            thread_id = in_other.thread_id;
+            fields_size = in_other.fields_size;
+            fields_spilled = in_other.fields_spilled;
+            std::memcpy(args.data(), in_other.args.data(), args_size + (fields_spilled ? 0 : fields_size));
+            return *this;
+        }
+
+        LogMessage ToMessage() {
+            std::string fields;
+            if (fields_spilled) {
+                fields.assign(message, message.size() - fields_size, fields_size);
+                message.resize(message.size() - fields_size);
+            } else if (fields_size != 0) {
+                fields.assign(reinterpret_cast<const char*>(args.data()) + args_size, fields_size);
+            }
+            auto msg{MakeMessage_()};
+            msg.fields = std::move(fields);
+            msg.location = location;
+            msg.thread_id = thread_id;
+            return msg;
+        }
+        /// Text of a record that was formatted by the caller, without the fields that may follow it.
+        std::string_view Text() const { return std::string_view{message}.substr(0, message.size() - (fields_spilled ? fields_size : 0)); }
+
+        std::chrono::system_clock::time_point time{};
+        std::string message{};  ///< Followed by the encoded fields if they didn't fit into args, see fields_spilled.
+        std::string_view format{};  ///< Format string of a deferred record, must stay alive until the logger thread formats it.
+        uint16_t args_size{0};
+        LogLevels level{LogLevels::Info};
+        bool deferred{false};
+        bool fields_spilled{false};  ///< The fields are the last fields_size bytes of message instead of following the arguments in args.
+        uint32_t fields_size{0};
+        uint64_t sinks{~uint64_t{0}};  ///< Bit i set: the record goes to the sink added i-th, see ModuleLogger::SetSinks().
+        SourceLocation location{};
+        uint64_t thread_id{0};
+        std::array<std::byte, details::kInlineArgsSize> args;
+
+       private:
+        LogMessage MakeMessage_() {
+            if (!deferred) return LogMessage{level, std::move(message), time};
+            try {
+                fmt::dynamic_format_arg_store<fmt::format_context> store;
+                details::DecodeArgs(args.data(), args_size, store);
+                LogMessage msg{level, fmt::vformat(format, store), time};
+                msg.format = format;
+                msg.args.assign(reinterpret_cast<const char*>(args.data()), args_size);
+                return msg;
+            } catch (const std::exception& e) {
+                return LogMessage{level, fmt::format("Failed to format \"{}\": {}", format, e.what()), time};
+            }
+        }
     };
 
     class BaseSink {
        public:
         virtual LogLevels GetLevel() = 0;
+        /// Called from the thread of Logger::SetSinkLevel() or Logger::LoadConfig() while the sink is writing, the level must be atomic.
         virtual void SetLevel(LogLevels in_level) = 0;
         virtual void Log(const LogMessage& in_msg) = 0;
+        /// Receives the whole batch drained by the logger thread. The default forwards every message to Log(), so per-message sinks keep working.
+        virtual void LogBatch(details::Span<const LogMessage> in_msgs) {
+            for (auto& msg : in_msgs) Log(msg);
+        }
         virtual void Flush() = 0;
+        /// Called by the crash handler (Logger::InstallCrashHandler) from a signal handler, while other threads may still use the sink.
+        /// Writes what the sink still holds in memory using async-signal-safe calls only: no allocation, no locks, no streams or fmt.
+        /// Data that can't go to the sink's own output may be written to in_crash_fd, see details::CrashWriter.
+        virtual void FlushOnCrash(int in_crash_fd) noexcept { (void)in_crash_fd; }
         virtual ~BaseSink() = default;
+        /// Bytes, rotations, open attempts and drops the sink reports about its output, see SinkStats.
+        const details::SinkIoCounters& GetIoCounters() const { return io_counters_; }
+
+       protected:
+        details::SinkIoCounters io_counters_{};
+    };
+
+    enum class SinkDispatch : uint8_t {
+        Inline,    ///< The sink runs on the logger thread.
+        Dedicated  ///< The sink runs on its own thread behind a bounded queue, a slow sink can't stall the others (unless it uses QueueFullPolicy::Block).
+    };
+
+    struct SinkOptions {
+        SinkDispatch dispatch{SinkDispatch::Inline};
+        size_t queue_capacity{8192};                              ///< Messages in the queue of a dedicated sink, rounded up to a power of two.
+        QueueFullPolicy full_policy{QueueFullPolicy::DropNewest};  ///< What the logger thread does when the queue of a dedicated sink is full.
+        std::string name{};  ///< Used by ModuleLogger::SetSinks(), SetSinkLevel() and the config file, "sink<index>" if empty.
+    };
+
+    /// Health of one sink, see Logger::GetSinksStats().
+    struct SinkStats {
+        SinkDispatch dispatch{SinkDispatch::Inline};
+        size_t queue_depth{0};                              ///< Messages waiting in the queue of a dedicated sink.
+        std::chrono::nanoseconds last_flush_latency{0};    ///< Duration of the last Flush() of the sink.
+        uint64_t dropped{0};                                ///< Messages dropped because the queue of the sink was full.
+        uint64_t logged{0};                                 ///< Messages handed to the sink.
+        HistogramSnapshot log_latency{};                    ///< Duration of every LogBatch() call of the sink.
+        HistogramSnapshot flush_latency{};                  ///< Duration of every Flush() call of the sink.
+        uint64_t bytes_written{0};
+        uint64_t rotations{0};
+        uint64_t open_attempts{0};  ///< Attempts to (re)open the output after it was unavailable.
+        uint64_t sink_dropped{0};   ///< Messages the sink lost itself, e.g. while its file couldn't be opened.
+    };
+
+    /// Snapshot of the logger, see Logger::GetMetrics().
+    struct LoggerMetrics {
+        std::chrono::system_clock::time_point time{};
+        uint64_t enqueued{0};             ///< Records handed to the logger queue by all threads, dropped ones included.
+        uint64_t dropped{0};              ///< Records lost because the logger queue was full.
+        double enqueue_rate{0};           ///< Records per second over the last full second.
+        size_t queue_depth{0};
+        size_t queue_high_water_mark{0};  ///< Deepest queue the logger thread has found at the start of a pass.
+        size_t queue_capacity{0};
+        std::vector<SinkStats> sinks{};
+
+        /// One line for the periodic dump, see Logger::SetMetricsDump().
+        std::string ToString() const;
     };
 
+    namespace details {
+        struct SinkCounters {
+            SinkDispatch dispatch{SinkDispatch::Inline};
+            std::atomic<size_t> queue_depth{0};
+            std::atomic<int64_t> last_flush_latency_ns{0};
+            std::atomic<uint64_t> dropped{0};
+            std::atomic<uint64_t> logged{0};
+            LatencyHistogram log_latency{};
+            LatencyHistogram flush_latency{};
+            const SinkIoCounters* io{nullptr};  ///< Of the wrapped sink for a dedicated one.
+        };
+
+        /// Replaces a run of identical messages (same level, text, fields, call site and sinks) with the first one and "last message repeated N times".
+        /// Runs on the logger thread. The summary is written at the end of every pass, so a storm costs one line per pass.
+        class DuplicateCollapser {
+           public:
+            void Add(LogMessage&& in_msg, uint64_t in_sinks, std::vector<LogMessage>& io_batch, std::vector<uint64_t>& io_batch_sinks) {
+                const LogMessage* last{last_index_ < io_batch.size() ? &io_batch[last_index_] : has_last_ ? &last_message_ : nullptr};
+                if (last != nullptr && in_sinks == last_sinks_ && IsRepeat_(in_msg, *last)) {
+                    repeats_++;
+                    last_time_ = in_msg.time;
+                    return;
+                }
+                FlushRepeats_(io_batch, io_batch_sinks);
+                last_level_ = in_msg.level;
+                last_sinks_ = in_sinks;
+                last_index_ = io_batch.size();
+                io_batch.push_back(std::move(in_msg));
+                io_batch_sinks.push_back(in_sinks);
+            }
+            /// Called before the batch is cleared: writes the pending summary and keeps the text of the last message for the next pass.
+            void EndPass(std::vector<LogMessage>& io_batch, std::vector<uint64_t>& io_batch_sinks) {
+                FlushRepeats_(io_batch, io_batch_sinks);
+                if (last_index_ < io_batch.size()) {
+                    const auto& last{io_batch[last_index_]};
+                    last_message_.level = last.level;
+                    last_message_.message = last.message;
+                    last_message_.fields = last.fields;
+                    last_message_.location = last.location;
+                    has_last_ = true;
+                }
+                last_index_ = kNoIndex;
+            }
+            /// Forgets the last message, e.g. when collapsing is turned off.
+            void Reset() {
+                repeats_ = 0;
+                has_last_ = false;
+                last_index_ = kNoIndex;
+            }
+
+           private:
+            /// Records that differ only in field values or come from another call site aren't repeats, the summary would lose them.
+            static bool IsRepeat_(const LogMessage& in_msg, const LogMessage& in_last) {
+                return in_msg.level == in_last.level && in_msg.location.line == in_last.location.line && in_msg.location.file == in_last.location.file && in_msg.message == in_last.message &&
+                       in_msg.fields == in_last.fields;
+            }
+            void FlushRepeats_(std::vector<LogMessage>& io_batch, std::vector<uint64_t>& io_batch_sinks) {
+                if (repeats_ == 0) return;
+                io_batch.emplace_back(last_level_, fmt::format("last message repeated {} times", repeats_), last_time_);
+                io_batch_sinks.push_back(last_sinks_);
+                repeats_ = 0;
+            }
+
+            static constexpr size_t kNoIndex{~size_t{0}};
+            size_t last_index_{kNoIndex};  ///< Of the last message in the batch of the current pass.
+            LogMessage last_message_{};    ///< Level, text, fields and location of the last message of the previous pass.
+            bool has_last_{false};
+            LogLevels last_level_{LogLevels::Info};
+            uint64_t last_sinks_{0};
+            uint64_t repeats_{0};
+            std::chrono::system_clock::time_point last_time_{};
+        };
+    }  // namespace details
+
+    /// When the logger thread starts a pass before log_interval_ expires.
+    struct WakeupPolicy {
+        size_t high_water_mark{0};                ///< Queued records that wake the logger thread, 0 for a quarter of the queue capacity.
+        LogLevels wake_level{LogLevels::Error};   ///< Messages at or above this level wake the logger thread, Off disables it.
+        std::chrono::microseconds spin_time{50};  ///< How long the logger thread polls for a wake-up before it parks.
+    };
+
+    class ModuleLogger;
+
     class Logger {
        public:
-        static void Initialize() {
+        /// Starts the logger thread. The queue of in_queue_capacity records (a power of two) is allocated by the first call, or by the first
+        /// message if that comes earlier, and keeps its capacity until the process exits.
+        static void Initialize(QueueFullPolicy in_policy = QueueFullPolicy::Block, size_t in_queue_capacity = kDefaultQueueCapacity) {
+            CreateQueue_(in_queue_capacity);
             std::lock_guard lock(mut_);
+            queue_full_policy_.store(in_policy, std::memory_order_relaxed);
             if (th_ == nullptr) {
-                th_ = new std::thread{[]() -> void {
-                    while (true) {
-                        std::this_thread::sleep_for(log_interval_);
-                        {
-                            std::lock_guard lock(mut_);
-                            for (auto& c : messages_) {  // First the messages then sinks. It's faster from the point of view of the cache.
-                                for (auto& sink : sinks_) {
-                                    sink->Log(c);
-                                }
-                            }
-                            for (auto& sink : sinks_) {
-                                sink->Flush();
-                            }
-                            messages_.clear();
-                        }
-                    };
-                }};
-                th_->detach();
+                if (!exit_handler_registered_) {  // Stop the thread before the static sinks are destroyed.
+                    std::atexit(Shutdown);
+                    exit_handler_registered_ = true;
+                }
+                stop_requested_.store(false, std::memory_order_relaxed);
+                consumer_running_.store(true, std::memory_order_release);
+                th_ = new std::thread{ConsumerLoop_};
             }
         }
-        static void AddSink(std::unique_ptr<BaseSink> in_sink) {
+        /// Stops the logger thread, writes everything that is still queued to the sinks and flushes them. Initialize() may be called again afterwards.
+        static void Shutdown() {
+            std::thread* th{nullptr};
+            {
+                std::lock_guard lock(mut_);
+                std::swap(th, th_);
+            }
+            if (th == nullptr) return;
+            {
+                std::lock_guard lock(wake_mut_);
+                stop_requested_.store(true, std::memory_order_seq_cst);
+                wake_cv_.notify_one();
+            }
+            th->join();
+            delete th;
+            consumer_running_.store(false, std::memory_order_release);
+            {
+                std::lock_guard lock(space_mut_);  // Producers blocked on a full queue give up.
+                space_cv_.notify_all();
+            }
+            WaitDedicatedSinks_();
+        }
+        static void AddSink(std::unique_ptr<BaseSink> in_sink) { AddSink(std::move(in_sink), SinkOptions{}); }
+        /// Adds a sink that runs on the logger thread (SinkDispatch::Inline) or on its own thread (SinkDispatch::Dedicated).
+        static void AddSink(std::unique_ptr<BaseSink> in_sink, const SinkOptions& in_options);
+        /// Stats of all sinks in the order they were added. Doesn't wait for a sink that is busy flushing.
+        static std::vector<SinkStats> GetSinksStats();
+        /// Logger counters and the stats of all sinks. Doesn't take any lock a producer or a sink could be holding.
+        static LoggerMetrics GetMetrics();
+        /// Every in_period the logger thread sends LoggerMetrics::ToString() as a message of in_level to the sinks. Zero disables it.
+        static void SetMetricsDump(std::chrono::steady_clock::duration in_period, LogLevels in_level = LogLevels::Info) {
             std::lock_guard lock(mut_);
-            if (in_sink->GetLevel() < log_level_) log_level_ = in_sink->GetLevel();
-            sinks_.push_back(std::move(in_sink));
+            metrics_dump_period_ = in_period;
+            metrics_dump_level_ = in_level;
         }
         static void SetLogInterval(std::chrono::steady_clock::duration in_interval) {
             std::lock_guard lock(mut_);
             log_interval_ = in_interval;
         }
 
+        static void SetWakeupPolicy(const WakeupPolicy& in_policy) {
+            std::lock_guard lock(mut_);
+            high_water_mark_.store(in_policy.high_water_mark, std::memory_order_relaxed);
+            wake_level_.store(in_policy.wake_level, std::memory_order_relaxed);
+            spin_time_ = in_policy.spin_time;
+        }
+
+        static void SetQueueFullPolicy(QueueFullPolicy in_policy) { queue_full_policy_.store(in_policy, std::memory_order_relaxed); }
+        static QueueFullPolicy GetQueueFullPolicy() { return queue_full_policy_.load(std::memory_order_relaxed); }
+        /// In deferred mode Log() only copies the format string pointer and the arguments, fmt::format runs on the logger thread.
+        /// Only FMT_COMPILE formats (the ADSVEL_LOG_* macros) with arguments are deferred, runtime format strings and arguments that can't be
+        /// encoded are still formatted in place.
+        static void SetDeferredFormatting(bool in_enabled) { deferred_formatting_.store(in_enabled, std::memory_order_relaxed); }
+        static bool GetDeferredFormatting() { return deferred_formatting_.load(std::memory_order_relaxed); }
+        /// Selects how LogMessage::time is taken. ClockSource::Tsc avoids system_clock::now() per message, it can be switched while logging.
+        static void SetClockSource(ClockSource in_source) { details::LogClock::SetSource(in_source); }
+        /// Opt-in: on SIGSEGV, SIGABRT, SIGBUS or SIGFPE the records still in the queue are written to in_crash_file (stderr if it is empty),
+        /// every sink gets FlushOnCrash(), then the previous handler of the signal runs. Costs nothing until a signal arrives.
+        /// A no-op where there are no POSIX signals (neither __unix__ nor __APPLE__ is defined).
+        static void InstallCrashHandler(const std::string& in_crash_file = "");
+        /// Named logger with its own level and sinks, created on the first call. The reference stays valid for the life of the program.
+        static ModuleLogger& GetModule(std::string_view in_name);
+        /// Level of the messages logged through Logger itself, Debug by default. The sink levels still apply.
+        static void SetLevel(LogLevels in_level);
+        static LogLevels GetLevel();
+        /// Changes the level of the sink added with SinkOptions::name in_sink_name. Returns false if there is no such sink.
+        static bool SetSinkLevel(std::string_view in_sink_name, LogLevels in_level);
+        /// Applies a level config, all of it or nothing (throws std::runtime_error naming the bad line). One setting per line, '#' starts a comment:
+        ///     default = Info          level of Logger itself
+        ///     net = Debug             level of GetModule("net")
+        ///     net.sinks = file, net   sinks of the module by SinkOptions::name, "*" for all
+        ///     sink.file = Warning     level of a sink
+        static void LoadConfig(const std::string& in_path);
+        /// The logger thread checks the modification time of in_path every in_period and calls LoadConfig() when it changes.
+        /// Errors are logged as Error messages, the previous settings stay. A zero period or an empty path disables it.
+        static void SetConfigReload(const std::string& in_path, std::chrono::steady_clock::duration in_period = std::chrono::seconds(1));
+        /// Opt-in: the logger thread replaces consecutive identical messages with "last message repeated N times", see details::DuplicateCollapser.
+        static void SetCollapseDuplicates(bool in_enabled) { collapse_duplicates_.store(in_enabled, std::memory_order_relaxed); }
+        static bool GetCollapseDuplicates() { return collapse_duplicates_.load(std::memory_order_relaxed); }
+        /// True if some sink takes messages of in_level from Logger, the check Log() starts with.
+        static bool ShouldLog(LogLevels in_level) { return static_cast<size_t>(in_level) < kLevelsCount && level_masks_[static_cast<size_t>(in_level)].load(std::memory_order_relaxed) != 0; }
+        /// Number of messages lost because the queue was full.
+        static uint64_t GetDroppedMessagesCount() { return details::ThreadCountersRegistry::Sum().dropped; }
+
         static void Flush() {
             std::lock_guard lock(mut_);
             for (auto& sink : sinks_) {
@@ -91,42 +416,435 @@ namespace adsvel::log {
 
         template <class... Args>
         static void Log(LogLevels in_level, const std::string_view& in_msg, const Args&... in_args) {
-            if (log_level_.load(std::memory_order::memory_order_relaxed) > in_level) return;
-            std::lock_guard lock(mut_);
-            messages_.push_back(LogMessage{in_level, fmt::format(in_msg, in_args...)});
+            LogImpl_(level_masks_, ~uint64_t{0}, SourceLocation{}, in_level, in_msg, in_args...);
+        }
+        /// Overload for FMT_COMPILE strings: the format is checked and parsed at build time.
+        template <class S, class... Args, std::enable_if_t<fmt::detail::is_compiled_string<S>::value, int> = 0>
+        static void Log(LogLevels in_level, const S& in_msg, const Args&... in_args) {
+            LogImpl_(level_masks_, ~uint64_t{0}, SourceLocation{}, in_level, in_msg, in_args...);
+        }
+        /// Same with the source location, used by the ADSVEL_LOG_* macros.
+        template <class S, class... Args, std::enable_if_t<fmt::detail::is_compiled_string<S>::value, int> = 0>
+        static void Log(const SourceLocation& in_location, LogLevels in_level, const S& in_msg, const Args&... in_args) {
+            LogImpl_(level_masks_, ~uint64_t{0}, in_location, in_level, in_msg, in_args...);
+        }
+        /// Structured message: a fixed text and typed fields the sinks keep apart, e.g. LogKv(LogLevels::Info, "request done", Kv("id", id), Kv("ms", ms)).
+        /// The fields are copied into the record without an allocation while they fit into details::kInlineArgsSize bytes.
+        template <class... Ts>
+        static void LogKv(LogLevels in_level, std::string_view in_msg, const Field<Ts>&... in_fields) {
+            LogKvImpl_(level_masks_, ~uint64_t{0}, SourceLocation{}, in_level, in_msg, in_fields...);
+        }
+        template <class... Ts>
+        static void LogKv(const SourceLocation& in_location, LogLevels in_level, std::string_view in_msg, const Field<Ts>&... in_fields) {
+            LogKvImpl_(level_masks_, ~uint64_t{0}, in_location, in_level, in_msg, in_fields...);
         }
 
         template <class... Args>
         inline static void Debug(const std::string_view& in_msg, const Args&... in_args) {
-            Log(LogLevels::Debug, in_msg, in_args...);
+            if constexpr (LogLevels::Debug >= kActiveLevel) Log(LogLevels::Debug, in_msg, in_args...);
         }
         template <class... Args>
         inline static void Trace(const std::string_view& in_msg, const Args&... in_args) {
-            Log(LogLevels::Trace, in_msg, in_args...);
+            if constexpr (LogLevels::Trace >= kActiveLevel) Log(LogLevels::Trace, in_msg, in_args...);
         }
         template <class... Args>
         inline static void Info(const std::string_view& in_msg, const Args&... in_args) {
-            Log(LogLevels::Info, in_msg, in_args...);
+            if constexpr (LogLevels::Info >= kActiveLevel) Log(LogLevels::Info, in_msg, in_args...);
         }
         template <class... Args>
         inline static void Warning(const std::string_view& in_msg, const Args&... in_args) {
-            Log(LogLevels::Warning, in_msg, in_args...);
+            if constexpr (LogLevels::Warning >= kActiveLevel) Log(LogLevels::Warning, in_msg, in_args...);
         }
         template <class... Args>
         inline static void Error(const std::string_view& in_msg, const Args&... in_args) {
-            Log(LogLevels::Error, in_msg, in_args...);
+            if constexpr (LogLevels::Error >= kActiveLevel) Log(LogLevels::Error, in_msg, in_args...);
         }
         template <class... Args>
         inline static void Critical(const std::string_view& in_msg, const Args&... in_args) {
-            Log(LogLevels::Critical, in_msg, in_args...);
+            if constexpr (LogLevels::Critical >= kActiveLevel) Log(LogLevels::Critical, in_msg, in_args...);
         }
 
+        static constexpr size_t kMaxSinks{64};  ///< Sinks are addressed by the bits of a uint64_t.
+
        private:
-        static std::vector<LogMessage> messages_;
+        friend class ModuleLogger;
+        /// Bit i of element L is set when the sink added i-th takes messages of level L.
+        using LevelMasks = std::array<std::atomic<uint64_t>, kLevelsCount>;
+
+        static void WaitDedicatedSinks_();
+        /// Rebuilds the level masks of Logger and of every module after a level or a route changed. mut_ must be held.
+        static void UpdateLevelMasks_();
+        static void UpdateLevelMasks_(LevelMasks& out_masks, LogLevels in_level, uint64_t in_route);
+        static void ReloadConfigIfChanged_(std::vector<LogMessage>& out_batch);
+        /// GetModule() without the lock, mut_ must be held.
+        static ModuleLogger& FindOrAddModule_(std::string_view in_name);
+        static void UpdateRate_();
+        static void OnFatalSignal_(int in_signal);
+        static details::MpmcQueue<LogRecord>& Queue_() {
+            auto queue{queue_.load(std::memory_order_acquire)};
+            return queue != nullptr ? *queue : CreateQueue_(kDefaultQueueCapacity);
+        }
+        /// Allocates the queue unless it exists already.
+        static details::MpmcQueue<LogRecord>& CreateQueue_(size_t in_capacity);
+        static void ConsumerLoop_() {
+            auto& queue{Queue_()};
+            std::vector<LogMessage> batch;
+            std::vector<uint64_t> batch_sinks;  // LogRecord::sinks of every message in batch.
+            std::vector<LogMessage> routed;
+            details::DuplicateCollapser collapser;
+            auto next_dump{std::chrono::steady_clock::now()};
+            while (true) {
+                bool stopping{stop_requested_.load(std::memory_order_seq_cst)};
+                details::LogClock::Calibrate();
+                auto depth{queue.SizeApprox()};
+                if (depth > queue_high_water_mark_.load(std::memory_order_relaxed)) queue_high_water_mark_.store(depth, std::memory_order_relaxed);
+                UpdateRate_();
+                // Producers are never blocked by the sinks: the queue is drained first and the lock only guards the sinks.
+                LogRecord record;
+                if (collapse_duplicates_.load(std::memory_order_relaxed)) {
+                    while (queue.TryPop(record)) collapser.Add(record.ToMessage(), record.sinks, batch, batch_sinks);
+                    collapser.EndPass(batch, batch_sinks);
+                } else {
+                    collapser.Reset();
+                    while (queue.TryPop(record)) {
+                        batch.push_back(record.ToMessage());
+                        batch_sinks.push_back(record.sinks);
+                    }
+                }
+                if (blocked_producers_.load(std::memory_order_seq_cst) != 0) {
+                    std::lock_guard lock(space_mut_);
+                    space_cv_.notify_all();
+                }
+                ReloadConfigIfChanged_(batch);
+                batch_sinks.resize(batch.size(), ~uint64_t{0});
+                uint64_t common_sinks{~uint64_t{0}};  // Sinks that get the whole batch.
+                for (auto sinks : batch_sinks) common_sinks &= sinks;
+                std::chrono::steady_clock::duration interval;
+                std::chrono::microseconds spin_time;
+                {
+                    std::lock_guard lock(mut_);
+                    if (metrics_dump_period_.count() > 0 && std::chrono::steady_clock::now() >= next_dump) {
+                        next_dump = std::chrono::steady_clock::now() + metrics_dump_period_;
+                        batch.emplace_back(metrics_dump_level_, GetMetrics().ToString(), details::LogClock::Now());
+                    }
+                    for (size_t i{0}; i < sinks_.size(); i++) {
+                        auto& counters{*sinks_counters_[i]};
+                        bool is_inline{counters.dispatch == SinkDispatch::Inline};  // A dedicated sink counts on its own thread.
+                        auto* msgs{&batch};
+                        if ((common_sinks >> i & 1) == 0) {  // Some messages come from modules routed away from this sink.
+                            routed.clear();
+                            for (size_t j{0}; j < batch.size(); j++) {
+                                if (j >= batch_sinks.size() || (batch_sinks[j] >> i & 1) != 0) routed.push_back(batch[j]);
+                            }
+                            msgs = &routed;
+                        }
+                        if (!msgs->empty()) {
+                            auto begin{std::chrono::steady_clock::now()};
+                            sinks_[i]->LogBatch(*msgs);
+                            if (is_inline) {
+                                counters.log_latency.Record(std::chrono::steady_clock::now() - begin);
+                                counters.logged.fetch_add(msgs->size(), std::memory_order_relaxed);
+                            }
+                        }
+                        auto begin{std::chrono::steady_clock::now()};
+                        sinks_[i]->Flush();
+                        if (is_inline) {
+                            auto latency{std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin)};
+                            counters.flush_latency.Record(latency);
+                            counters.last_flush_latency_ns.store(latency.count(), std::memory_order_relaxed);
+                        }
+                    }
+                    interval = log_interval_;
+                    spin_time = spin_time_;
+                }
+                batch.clear();
+                batch_sinks.clear();
+                if (stopping) break;  // The queue was drained after the stop request was seen.
+                WaitForWork_(interval, spin_time);
+            }
+        }
+        /// Sleeps until the interval expires or a producer asks for an early pass. Spins for spin_time first so a burst right after a pass
+        /// doesn't pay for a futex wake-up.
+        static void WaitForWork_(std::chrono::steady_clock::duration in_interval, std::chrono::microseconds in_spin_time) {
+            auto deadline{std::chrono::steady_clock::now() + in_interval};
+            auto spin_deadline{std::min(deadline, std::chrono::steady_clock::now() + in_spin_time)};
+            while (std::chrono::steady_clock::now() < spin_deadline) {
+                if (wake_requested_.exchange(false, std::memory_order_acquire) || stop_requested_.load(std::memory_order_relaxed)) return;
+                std::this_thread::yield();
+            }
+            std::unique_lock lock(wake_mut_);
+            consumer_parked_.store(true, std::memory_order_seq_cst);
+            wake_cv_.wait_until(lock, deadline, []() { return wake_requested_.load(std::memory_order_seq_cst) || stop_requested_.load(std::memory_order_seq_cst); });
+            consumer_parked_.store(false, std::memory_order_relaxed);
+            wake_requested_.store(false, std::memory_order_relaxed);
+        }
+        static void WakeConsumer_() {
+            if (wake_requested_.exchange(true, std::memory_order_seq_cst)) return;  // Someone already asked.
+            if (consumer_parked_.load(std::memory_order_seq_cst)) {
+                std::lock_guard lock(wake_mut_);
+                wake_cv_.notify_one();
+            }
+        }
+
+        /// in_masks says which sinks want in_level, a message nobody wants is dropped before it is formatted. in_route goes to LogRecord::sinks.
+        template <class S, class... Args>
+        static void LogImpl_(const LevelMasks& in_masks, uint64_t in_route, const SourceLocation& in_location, LogLevels in_level, const S& in_msg, const Args&... in_args) {
+            if (static_cast<size_t>(in_level) >= kLevelsCount || in_masks[static_cast<size_t>(in_level)].load(std::memory_order_relaxed) == 0) return;
+            LogRecord record;
+            record.time = details::LogClock::Now();
+            record.level = in_level;
+            record.sinks = in_route;
+            record.location = in_location;
+            record.thread_id = details::CurrentThreadId();
+            // Only a compile-time format is known to outlive the record, a runtime one may be a temporary of the caller.
+            // Without arguments there is nothing to save, the text is the format.
+            if constexpr (fmt::detail::is_compiled_string<S>::value && sizeof...(Args) > 0 && details::kAllArgsDeferrable<Args...>) {
+                if (deferred_formatting_.load(std::memory_order_relaxed)) {
+                    std::size_t args_size{0};
+                    if (details::EncodeArgs(record.args.data(), record.args.size(), args_size, in_args...)) {
+                        auto format{fmt::string_view(in_msg)};
+                        record.format = std::string_view{format.data(), format.size()};
+                        record.args_size = static_cast<uint16_t>(args_size);
+                        record.deferred = true;
+                        Enqueue_(std::move(record));
+                        return;
+                    }
+                }
+            }
+            record.message = fmt::format(in_msg, in_args...);
+            Enqueue_(std::move(record));
+        }
+        template <class... Ts>
+        static void LogKvImpl_(const LevelMasks& in_masks, uint64_t in_route, const SourceLocation& in_location, LogLevels in_level, std::string_view in_msg, const Field<Ts>&... in_fields) {
+            if (static_cast<size_t>(in_level) >= kLevelsCount || in_masks[static_cast<size_t>(in_level)].load(std::memory_order_relaxed) == 0) return;
+            LogRecord record;
+            record.time = details::LogClock::Now();
+            record.level = in_level;
+            record.sinks = in_route;
+            record.location = in_location;
+            record.thread_id = details::CurrentThreadId();
+            record.message = in_msg;
+            std::size_t fields_size{0};
+            if (!details::EncodeFields(record.args.data(), record.args.size(), fields_size, in_fields...)) {
+                details::EncodeFields(record.message, in_fields...);
+                fields_size = record.message.size() - in_msg.size();
+                record.fields_spilled = true;
+            }
+            record.fields_size = static_cast<uint32_t>(fields_size);
+            Enqueue_(std::move(record));
+        }
+
+        static void Enqueue_(LogRecord&& in_msg) {
+            auto& thread_counters{details::ThreadCountersRegistry::Local()};
+            details::BumpCounter(thread_counters.enqueued);
+            auto level{in_msg.level};
+            auto& queue{Queue_()};
+            if (queue.TryPush(std::move(in_msg))) {
+                auto high_water_mark{high_water_mark_.load(std::memory_order_relaxed)};
+                if (high_water_mark == 0) high_water_mark = queue.Capacity() / 4;
+                if (level >= wake_level_.load(std::memory_order_relaxed) || queue.SizeApprox() >= high_water_mark) WakeConsumer_();
+                return;
+            }
+            WakeConsumer_();
+            switch (queue_full_policy_.load(std::memory_order_relaxed)) {
+                case QueueFullPolicy::Block: {
+                    // Parks until the logger thread has drained the queue. The wait is bounded in case the logger thread is stuck in a sink.
+                    blocked_producers_.fetch_add(1, std::memory_order_seq_cst);
+                    bool pushed{false};
+                    {
+                        std::unique_lock lock(space_mut_);
+                        while (!pushed && consumer_running_.load(std::memory_order_acquire)) {
+                            pushed = queue.TryPush(std::move(in_msg));
+                            if (!pushed) space_cv_.wait_for(lock, kBlockedRecheckPeriod);
+                        }
+                    }
+                    blocked_producers_.fetch_sub(1, std::memory_order_relaxed);
+                    if (pushed) return;
+                    break;
+                }
+                case QueueFullPolicy::DropNewest:
+                    break;
+                case QueueFullPolicy::OverwriteOldest: {
+                    LogRecord evicted;
+                    do {
+                        if (queue.TryPop(evicted)) details::BumpCounter(thread_counters.dropped);
+                    } while (!queue.TryPush(std::move(in_msg)));
+                    return;
+                }
+            }
+            details::BumpCounter(thread_counters.dropped);
+        }
+
+        static constexpr std::chrono::milliseconds kBlockedRecheckPeriod{10};
+        static std::atomic<details::MpmcQueue<LogRecord>*> queue_;  // Set once by CreateQueue_(), owned by queue_storage_.
+        static std::unique_ptr<details::MpmcQueue<LogRecord>> queue_storage_;
         static std::vector<std::unique_ptr<BaseSink>> sinks_;
+        static std::vector<std::shared_ptr<details::SinkCounters>> sinks_counters_;  // Parallel to sinks_, guarded by mut_.
+        static std::vector<std::string> sinks_names_;                                // Parallel to sinks_, guarded by mut_.
+        static std::vector<std::shared_ptr<details::SinkCounters>> stats_counters_;  // Same counters for GetSinksStats(), guarded by stats_mut_.
+        static std::mutex stats_mut_;
         static std::chrono::steady_clock::duration log_interval_;
-        static std::mutex mut_;
-        static std::atomic<LogLevels> log_level_;  // Maximum logging level of the logger's sinks.
+        static std::mutex mut_;  // Guards the sinks and the settings of the logger thread, never taken by Log().
+        static std::atomic<QueueFullPolicy> queue_full_policy_;
+        static std::atomic<size_t> queue_high_water_mark_;
+        static std::atomic<double> enqueue_rate_;
+        static std::chrono::steady_clock::duration metrics_dump_period_;
+        static LogLevels metrics_dump_level_;
+        static std::atomic<bool> consumer_running_;
+        static std::atomic<bool> deferred_formatting_;
+        static std::atomic<bool> collapse_duplicates_;
+        static std::atomic<bool> stop_requested_;
+        static std::atomic<bool> wake_requested_;
+        static std::atomic<bool> consumer_parked_;
+        static std::atomic<size_t> high_water_mark_;
+        static std::atomic<LogLevels> wake_level_;
+        static std::chrono::microseconds spin_time_;
+        static std::mutex wake_mut_;  // Only for parking the logger thread.
+        static std::condition_variable wake_cv_;
+        static std::mutex space_mut_;  // Only for parking the producers that wait for a free slot (QueueFullPolicy::Block).
+        static std::condition_variable space_cv_;
+        static std::atomic<uint32_t> blocked_producers_;
+        static bool exit_handler_registered_;
+        static LevelMasks level_masks_;  // Of Logger itself, written under mut_.
+        static LogLevels level_;
+        static std::deque<ModuleLogger> modules_;  // Guarded by mut_, a deque keeps the references from GetModule() valid.
+        static std::string config_path_;           // Settings of SetConfigReload(), guarded by mut_.
+        static std::chrono::steady_clock::duration config_reload_period_;
         static std::thread* th_;
     };
+
+    /// Logger of one subsystem, see Logger::GetModule(). Messages go through the same queue and logger thread as the ones of Logger, but the
+    /// module has its own level and may be routed to a subset of the sinks. Whether any sink wants a level is precomputed, so a filtered
+    /// out call costs one relaxed load and never formats its arguments.
+    class ModuleLogger {
+       public:
+        explicit ModuleLogger(std::string in_name, LogLevels in_level) : name_{std::move(in_name)}, level_{in_level} {}
+        ModuleLogger(const ModuleLogger&) = delete;
+        ModuleLogger& operator=(const ModuleLogger&) = delete;
+
+        const std::string& GetName() const { return name_; }
+        LogLevels GetLevel() const;
+        void SetLevel(LogLevels in_level);
+        /// Sends the module's messages only to the sinks with these SinkOptions::name, an empty list means all sinks (the default).
+        /// Throws std::invalid_argument for an unknown name.
+        void SetSinks(const std::vector<std::string>& in_sink_names);
+        /// True if some sink takes messages of in_level from this module.
+        bool ShouldLog(LogLevels in_level) const { return static_cast<size_t>(in_level) < kLevelsCount && level_masks_[static_cast<size_t>(in_level)].load(std::memory_order_relaxed) != 0; }
+
+        template <class... Args>
+        void Log(LogLevels in_level, const std::string_view& in_msg, const Args&... in_args) {
+            Logger::LogImpl_(level_masks_, route_.load(std::memory_order_relaxed), SourceLocation{}, in_level, in_msg, in_args...);
+        }
+        template <class S, class... Args, std::enable_if_t<fmt::detail::is_compiled_string<S>::value, int> = 0>
+        void Log(LogLevels in_level, const S& in_msg, const Args&... in_args) {
+            Logger::LogImpl_(level_masks_, route_.load(std::memory_order_relaxed), SourceLocation{}, in_level, in_msg, in_args...);
+        }
+        template <class S, class... Args, std::enable_if_t<fmt::detail::is_compiled_string<S>::value, int> = 0>
+        void Log(const SourceLocation& in_location, LogLevels in_level, const S& in_msg, const Args&... in_args) {
+            Logger::LogImpl_(level_masks_, route_.load(std::memory_order_relaxed), in_location, in_level, in_msg, in_args...);
+        }
+        template <class... Ts>
+        void LogKv(LogLevels in_level, std::string_view in_msg, const Field<Ts>&... in_fields) {
+            Logger::LogKvImpl_(level_masks_, route_.load(std::memory_order_relaxed), SourceLocation{}, in_level, in_msg, in_fields...);
+        }
+        template <class... Ts>
+        void LogKv(const SourceLocation& in_location, LogLevels in_level, std::string_view in_msg, const Field<Ts>&... in_fields) {
+            Logger::LogKvImpl_(level_masks_, route_.load(std::memory_order_relaxed), in_location, in_level, in_msg, in_fields...);
+        }
+
+        template <class... Args>
+        void Debug(const std::string_view& in_msg, const Args&... in_args) {
+            if constexpr (LogLevels::Debug >= kActiveLevel) Log(LogLevels::Debug, in_msg, in_args...);
+        }
+        template <class... Args>
+        void Trace(const std::string_view& in_msg, const Args&... in_args) {
+            if constexpr (LogLevels::Trace >= kActiveLevel) Log(LogLevels::Trace, in_msg, in_args...);
+        }
+        template <class... Args>
+        void Info(const std::string_view& in_msg, const Args&... in_args) {
+            if constexpr (LogLevels::Info >= kActiveLevel) Log(LogLevels::Info, in_msg, in_args...);
+        }
+        template <class... Args>
+        void Warning(const std::string_view& in_msg, const Args&... in_args) {
+            if constexpr (LogLevels::Warning >= kActiveLevel) Log(LogLevels::Warning, in_msg, in_args...);
+        }
+        template <class... Args>
+        void Error(const std::string_view& in_msg, const Args&... in_args) {
+            if constexpr (LogLevels::Error >= kActiveLevel) Log(LogLevels::Error, in_msg, in_args...);
+        }
+        template <class... Args>
+        void Critical(const std::string_view& in_msg, const Args&... in_args) {
+            if constexpr (LogLevels::Critical >= kActiveLevel) Log(LogLevels::Critical, in_msg, in_args...);
+        }
+
+       private:
+        friend class Logger;
+        const std::string name_;
+        LogLevels level_;                             // Guarded by Logger::mut_.
+        std::atomic<uint64_t> route_{~uint64_t{0}};  // Written under Logger::mut_.
+        Logger::LevelMasks level_masks_{};            // Written under Logger::mut_.
+    };
 }  // namespace adsvel::log
+
+// Logging macros with a compile-time checked format string. Statements below ADSVEL_LOG_ACTIVE_LEVEL expand to nothing, so their arguments are never evaluated.
+#if ADSVEL_LOG_ACTIVE_LEVEL <= ADSVEL_LOG_LEVEL_DEBUG
+#define ADSVEL_LOG_DEBUG(format, ...) ::adsvel::log::Logger::Log(ADSVEL_LOG_HERE, ::adsvel::log::LogLevels::Debug, FMT_COMPILE(format), ##__VA_ARGS__)
+#else
+#define ADSVEL_LOG_DEBUG(...) (void)0
+#endif
+#if ADSVEL_LOG_ACTIVE_LEVEL <= ADSVEL_LOG_LEVEL_TRACE
+#define ADSVEL_LOG_TRACE(format, ...) ::adsvel::log::Logger::Log(ADSVEL_LOG_HERE, ::adsvel::log::LogLevels::Trace, FMT_COMPILE(format), ##__VA_ARGS__)
+#else
+#define ADSVEL_LOG_TRACE(...) (void)0
+#endif
+#if ADSVEL_LOG_ACTIVE_LEVEL <= ADSVEL_LOG_LEVEL_INFO
+#define ADSVEL_LOG_INFO(format, ...) ::adsvel::log::Logger::Log(ADSVEL_LOG_HERE, ::adsvel::log::LogLevels::Info, FMT_COMPILE(format), ##__VA_ARGS__)
+#else
+#define ADSVEL_LOG_INFO(...) (void)0
+#endif
+#if ADSVEL_LOG_ACTIVE_LEVEL <= ADSVEL_LOG_LEVEL_WARNING
+#define ADSVEL_LOG_WARNING(format, ...) ::adsvel::log::Logger::Log(ADSVEL_LOG_HERE, ::adsvel::log::LogLevels::Warning, FMT_COMPILE(format), ##__VA_ARGS__)
+#else
+#define ADSVEL_LOG_WARNING(...) (void)0
+#endif
+#if ADSVEL_LOG_ACTIVE_LEVEL <= ADSVEL_LOG_LEVEL_ERROR
+#define ADSVEL_LOG_ERROR(format, ...) ::adsvel::log::Logger::Log(ADSVEL_LOG_HERE, ::adsvel::log::LogLevels::Error, FMT_COMPILE(format), ##__VA_ARGS__)
+#else
+#define ADSVEL_LOG_ERROR(...) (void)0
+#endif
+#if ADSVEL_LOG_ACTIVE_LEVEL <= ADSVEL_LOG_LEVEL_CRITICAL
+#define ADSVEL_LOG_CRITICAL(format, ...) ::adsvel::log::Logger::Log(ADSVEL_LOG_HERE, ::adsvel::log::LogLevels::Critical, FMT_COMPILE(format), ##__VA_ARGS__)
+#else
+#define ADSVEL_LOG_CRITICAL(...) (void)0
+#endif
+
+// Same for a ModuleLogger: ADSVEL_LOG_MODULE(net, Info, "connected to {}", host). Statements below ADSVEL_LOG_ACTIVE_LEVEL are removed by the compiler.
+#define ADSVEL_LOG_MODULE(module, level, format, ...)                                                                     \
+    do {                                                                                                                  \
+        if constexpr (::adsvel::log::LogLevels::level >= ::adsvel::log::kActiveLevel)                                     \
+            (module).Log(ADSVEL_LOG_HERE, ::adsvel::log::LogLevels::level, FMT_COMPILE(format), ##__VA_ARGS__);            \
+    } while (false)
+
+// Structured message with the source location: ADSVEL_LOG_KV(Info, "request done", ::adsvel::log::Kv("id", id), ::adsvel::log::Kv("ms", ms)).
+#define ADSVEL_LOG_KV(level, message, ...)                                                                                \
+    do {                                                                                                                  \
+        if constexpr (::adsvel::log::LogLevels::level >= ::adsvel::log::kActiveLevel)                                     \
+            ::adsvel::log::Logger::LogKv(ADSVEL_LOG_HERE, ::adsvel::log::LogLevels::level, message, ##__VA_ARGS__);        \
+    } while (false)
+
+// Per call site limits, for statements in hot loops. The limiter is only consulted when some sink wants the level, and nothing is formatted
+// when it says no. The level is given without a prefix: ADSVEL_LOG_EVERY_N(Error, 1000, "request {} failed", id).
+#define ADSVEL_LOG_LIMITED_(limiter, allow_args, level, format, ...)                                                        \
+    do {                                                                                                                  \
+        if constexpr (::adsvel::log::LogLevels::level >= ::adsvel::log::kActiveLevel) {                                   \
+            static ::adsvel::log::details::limiter adsvel_log_limiter_;                                                  \
+            if (::adsvel::log::Logger::ShouldLog(::adsvel::log::LogLevels::level) && adsvel_log_limiter_.Allow allow_args) \
+                ::adsvel::log::Logger::Log(ADSVEL_LOG_HERE, ::adsvel::log::LogLevels::level, FMT_COMPILE(format), ##__VA_ARGS__); \
+        }                                                                                                                 \
+    } while (false)
+/// Logs the 1st, (n+1)-th, (2n+1)-th... time the statement runs.
+#define ADSVEL_LOG_EVERY_N(level, n, format, ...) ADSVEL_LOG_LIMITED_(EveryN, (n), level, format, ##__VA_ARGS__)
+/// Logs the first n times the statement runs.
+#define ADSVEL_LOG_FIRST_N(level, n, format, ...) ADSVEL_LOG_LIMITED_(FirstN, (n), level, format, ##__VA_ARGS__)
+/// Logs at most per_second times a second on average, with bursts of up to burst messages.
+#define ADSVEL_LOG_RATE_LIMITED(level, per_second, burst, format, ...) ADSVEL_LOG_LIMITED_(TokenBucket, ((per_second), (burst)), level, format, ##__VA_ARGS__)
@@ -0,0 +1,68 @@
+/**
+***************************************************************************************************************************************************************
+* @file     binary_format.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 20:10:06
+* @brief    Layout of the binary log files written by BinarySink and read by adsvel_log_decode.
+* @details  A file starts with kBinaryLogMagic and is followed by records, each starting with a BinaryRecordType byte:
+*           - FormatDef: varint format id, varint length, format string. Every format string is written once per file, before its first use.
+*           - Message:   varint format id, zigzag varint time delta in ns to the previous message (the first one is relative to the epoch),
+*                        level byte, varint arguments length, arguments in the deferred_args.h encoding.
+*           Every file is self-contained, the interning table starts over after rotation.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+namespace adsvel::log::details {
+    constexpr std::string_view kBinaryLogMagic{"ADSVLOG1"};
+
+    enum class BinaryRecordType : uint8_t { FormatDef = 1, Message = 2 };
+
+    template <class Buffer>
+    void PutVarint(Buffer& out_buffer, uint64_t in_value) {
+        while (in_value >= 0x80) {
+            out_buffer.push_back(static_cast<char>((in_value & 0x7F) | 0x80));
+            in_value >>= 7;
+        }
+        out_buffer.push_back(static_cast<char>(in_value));
+    }
+    inline uint64_t ZigZagEncode(int64_t in_value) { return (static_cast<uint64_t>(in_value) << 1) ^ static_cast<uint64_t>(in_value >> 63); }
+    inline int64_t ZigZagDecode(uint64_t in_value) { return static_cast<int64_t>(in_value >> 1) ^ -static_cast<int64_t>(in_value & 1); }
+
+    /// Sequential reader over a binary log. Throws std::out_of_range on truncated data.
+    class BinaryReader {
+       public:
+        explicit BinaryReader(std::string_view in_data) : data_{in_data} {}
+
+        bool AtEnd() const { return pos_ >= data_.size(); }
+        size_t Position() const { return pos_; }
+        uint8_t Byte() {
+            if (pos_ >= data_.size()) throw std::out_of_range("Truncated binary log.");
+            return static_cast<uint8_t>(data_[pos_++]);
+        }
+        uint64_t Varint() {
+            uint64_t value{0};
+            for (int shift{0}; shift < 64; shift += 7) {
+                auto byte{Byte()};
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return value;
+            }
+            throw std::out_of_range("Malformed varint in binary log.");
+        }
+        std::string_view Bytes(size_t in_size) {
+            if (in_size > data_.size() - pos_) throw std::out_of_range("Truncated binary log.");
+            auto bytes{data_.substr(pos_, in_size)};
+            pos_ += in_size;
+            return bytes;
+        }
+
+       private:
+        std::string_view data_;
+        size_t pos_{0};
+    };
+}  // namespace adsvel::log::details
@@ -0,0 +1,211 @@
+/**
+***************************************************************************************************************************************************************
+* @file     crash_writer.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 23:05:12
+* @brief    Async-signal-safe line writer for the crash handler (Logger::InstallCrashHandler).
+* @details  Nothing here allocates, locks or calls into stdio/fmt: lines are put together in a fixed buffer and written with write(2).
+*           The time is printed as seconds since the epoch, localtime() isn't safe in a signal handler. Deferred records are formatted by a
+*           minimal substitution of "{}" / "{N}" fields, format specs are ignored and floating point values are printed with 6 decimals.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include "deferred_args.h"
+namespace adsvel::log::details {
+    /// Writes in_size bytes to in_fd, retrying short writes and EINTR.
+    inline void WriteAll(int in_fd, const char* in_data, size_t in_size) noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+        while (in_size > 0) {
+            auto written{::write(in_fd, in_data, in_size)};
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            in_data += written;
+            in_size -= static_cast<size_t>(written);
+        }
+#else  // Only the crash handler writes through it, and it is installed on POSIX systems only.
+        (void)in_fd;
+        (void)in_data;
+        (void)in_size;
+#endif
+    }
+
+    class CrashWriter {
+       public:
+        explicit CrashWriter(int in_fd) noexcept : fd_{in_fd} {}
+        ~CrashWriter() { Flush(); }
+        CrashWriter(const CrashWriter&) = delete;
+        CrashWriter& operator=(const CrashWriter&) = delete;
+
+        void Flush() noexcept {
+            WriteAll(fd_, buffer_, size_);
+            size_ = 0;
+        }
+        CrashWriter& Append(std::string_view in_text) noexcept {
+            while (!in_text.empty()) {
+                if (size_ == sizeof(buffer_)) Flush();
+                size_t part{std::min(in_text.size(), sizeof(buffer_) - size_)};
+                std::memcpy(buffer_ + size_, in_text.data(), part);
+                size_ += part;
+                in_text.remove_prefix(part);
+            }
+            return *this;
+        }
+        CrashWriter& Append(uint64_t in_value, unsigned in_base = 10, size_t in_min_digits = 1) noexcept {
+            char digits[64];
+            size_t count{0};
+            do {
+                digits[count++] = "0123456789abcdef"[in_value % in_base];
+                in_value /= in_base;
+            } while (in_value != 0 || count < in_min_digits);
+            char text[64];
+            for (size_t i{0}; i < count; i++) text[i] = digits[count - 1 - i];
+            return Append(std::string_view{text, count});
+        }
+        CrashWriter& Append(int64_t in_value) noexcept {
+            if (in_value >= 0) return Append(static_cast<uint64_t>(in_value));
+            Append("-");
+            return Append(static_cast<uint64_t>(0) - static_cast<uint64_t>(in_value));
+        }
+        CrashWriter& Append(double in_value) noexcept {
+            if (std::isnan(in_value)) return Append("nan");
+            if (in_value < 0) {
+                Append("-");
+                in_value = -in_value;
+            }
+            if (std::isinf(in_value)) return Append("inf");
+            if (in_value >= 1e19) return Append("1e19+");
+            auto integral{static_cast<uint64_t>(in_value)};
+            auto fraction{static_cast<uint64_t>((in_value - static_cast<double>(integral)) * 1e6 + 0.5)};
+            if (fraction >= 1000000) {
+                integral++;
+                fraction -= 1000000;
+            }
+            Append(integral);
+            Append(".");
+            return Append(fraction, 10, 6);
+        }
+
+        /// "[seconds.nanoseconds][level ] text\n", the FileSink layout with an epoch timestamp.
+        void Line(std::chrono::system_clock::time_point in_time, std::string_view in_level, std::string_view in_text) noexcept {
+            LinePrefix_(in_time, in_level);
+            Append(in_text);
+            Append("\n");
+        }
+        /// Same for a deferred record: in_args is in the EncodeArgs() encoding.
+        void DeferredLine(std::chrono::system_clock::time_point in_time, std::string_view in_level, std::string_view in_format, const std::byte* in_args, size_t in_args_size) noexcept {
+            LinePrefix_(in_time, in_level);
+            constexpr size_t kMaxArgs{32};
+            size_t offsets[kMaxArgs];
+            size_t count{IndexArgs_(in_args, in_args_size, offsets, kMaxArgs)};
+            size_t next_arg{0};
+            for (size_t i{0}; i < in_format.size(); i++) {
+                char c{in_format[i]};
+                if ((c == '{' || c == '}') && i + 1 < in_format.size() && in_format[i + 1] == c) {  // "{{" and "}}"
+                    Append(std::string_view{&in_format[i], 1});
+                    i++;
+                    continue;
+                }
+                if (c != '{') {
+                    Append(std::string_view{&in_format[i], 1});
+                    continue;
+                }
+                auto end{in_format.find('}', i)};
+                if (end == std::string_view::npos) break;
+                size_t index{next_arg++};
+                if (i + 1 < end && in_format[i + 1] >= '0' && in_format[i + 1] <= '9') {
+                    index = 0;
+                    for (size_t j{i + 1}; j < end && in_format[j] >= '0' && in_format[j] <= '9'; j++) index = index * 10 + static_cast<size_t>(in_format[j] - '0');
+                }
+                if (index < count) AppendArg_(in_args, in_args_size, offsets[index]);
+                i = end;
+            }
+            Append("\n");
+        }
+
+       private:
+        void LinePrefix_(std::chrono::system_clock::time_point in_time, std::string_view in_level) noexcept {
+            auto ns{std::chrono::duration_cast<std::chrono::nanoseconds>(in_time.time_since_epoch()).count()};
+            Append("[");
+            Append(static_cast<int64_t>(ns / 1000000000));
+            Append(".");
+            Append(static_cast<uint64_t>(ns % 1000000000), 10, 9);
+            Append("][");
+            Append(in_level);
+            for (size_t i{in_level.size()}; i < 6; i++) Append(" ");
+            Append("] ");
+        }
+
+        template <class T>
+        static T Read_(const std::byte* in_data) noexcept {
+            T value;
+            std::memcpy(&value, in_data, sizeof(T));
+            return value;
+        }
+        static size_t ArgSize_(ArgType in_type, const std::byte* in_payload, size_t in_available) noexcept {
+            switch (in_type) {
+                case ArgType::Bool: return sizeof(uint8_t);
+                case ArgType::Char: return sizeof(char);
+                case ArgType::Int64: return sizeof(int64_t);
+                case ArgType::UInt64: return sizeof(uint64_t);
+                case ArgType::Float: return sizeof(float);
+                case ArgType::Double: return sizeof(double);
+                case ArgType::Pointer: return sizeof(uintptr_t);
+                case ArgType::String:
+                    if (in_available < sizeof(uint32_t)) return in_available + 1;
+                    return sizeof(uint32_t) + Read_<uint32_t>(in_payload);
+            }
+            return in_available + 1;
+        }
+        /// Offsets of the type bytes of up to in_max arguments, stops at the first malformed one.
+        static size_t IndexArgs_(const std::byte* in_args, size_t in_size, size_t* out_offsets, size_t in_max) noexcept {
+            size_t count{0};
+            size_t pos{0};
+            while (pos < in_size && count < in_max) {
+                auto type{static_cast<ArgType>(in_args[pos])};
+                auto size{ArgSize_(type, in_args + pos + 1, in_size - pos - 1)};
+                if (size > in_size - pos - 1) break;
+                out_offsets[count++] = pos;
+                pos += 1 + size;
+            }
+            return count;
+        }
+        void AppendArg_(const std::byte* in_args, size_t in_size, size_t in_offset) noexcept {
+            auto type{static_cast<ArgType>(in_args[in_offset])};
+            auto payload{in_args + in_offset + 1};
+            switch (type) {
+                case ArgType::Bool: Append(Read_<uint8_t>(payload) != 0 ? "true" : "false"); break;
+                case ArgType::Char: Append(std::string_view{reinterpret_cast<const char*>(payload), 1}); break;
+                case ArgType::Int64: Append(Read_<int64_t>(payload)); break;
+                case ArgType::UInt64: Append(Read_<uint64_t>(payload)); break;
+                case ArgType::Float: Append(static_cast<double>(Read_<float>(payload))); break;
+                case ArgType::Double: Append(Read_<double>(payload)); break;
+                case ArgType::Pointer:
+                    Append("0x");
+                    Append(static_cast<uint64_t>(Read_<uintptr_t>(payload)), 16);
+                    break;
+                case ArgType::String: {
+                    auto length{Read_<uint32_t>(payload)};
+                    if (in_offset + 1 + sizeof(uint32_t) + length <= in_size) Append(std::string_view{reinterpret_cast<const char*>(payload + sizeof(uint32_t)), length});
+                } break;
+            }
+        }
+
+        int fd_;
+        size_t size_{0};
+        char buffer_[4096];
+    };
+}  // namespace adsvel::log::details
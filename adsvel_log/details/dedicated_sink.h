@@ -0,0 +1,173 @@
+/**
+***************************************************************************************************************************************************************
+* @file     dedicated_sink.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 19:05:52
+* @brief    Runs a sink on its own thread behind a bounded queue.
+* @details  DedicatedSink is a BaseSink adapter: the logger thread copies the messages the wrapped sink accepts into the adapter's queue and
+*           returns immediately, the worker thread calls LogBatch() and Flush() of the wrapped sink. A sink stalled on a slow disk only fills
+*           its own queue, what happens then is decided by SinkOptions::full_policy.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#include "../adsvel_log.h"
+#include "crash_writer.h"
+namespace adsvel::log::details {
+    class DedicatedSink : public BaseSink {
+       public:
+        DedicatedSink(std::unique_ptr<BaseSink> in_sink, const SinkOptions& in_options, std::shared_ptr<SinkCounters> in_counters)
+            : sink_{std::move(in_sink)}, queue_{RoundUpToPowerOfTwo_(in_options.queue_capacity)}, full_policy_{in_options.full_policy}, counters_{std::move(in_counters)}, worker_{[this]() { WorkerLoop_(); }} {}
+        ~DedicatedSink() override {
+            {
+                std::lock_guard lock(mut_);
+                stop_requested_ = true;
+            }
+            cv_.notify_one();
+            worker_.join();
+        }
+
+        LogLevels GetLevel() override final { return sink_->GetLevel(); }
+        void SetLevel(LogLevels in_level) override final { sink_->SetLevel(in_level); }
+        void Log(const LogMessage& in_msg) override final {
+            if (sink_->GetLevel() <= in_msg.level) Push_(in_msg);
+            Notify_(false);
+        }
+        void LogBatch(Span<const LogMessage> in_msgs) override final {
+            auto level{sink_->GetLevel()};
+            for (auto& msg : in_msgs) {
+                if (level <= msg.level) Push_(msg);  // Messages the sink would drop aren't copied at all.
+            }
+            Notify_(false);
+        }
+        /// Asks the worker to flush the wrapped sink, doesn't wait for it.
+        void Flush() override final { Notify_(true); }
+        /// The queued messages can't be formatted safely by the wrapped sink, their text goes to in_crash_fd.
+        void FlushOnCrash(int in_crash_fd) noexcept override final {
+            {
+                CrashWriter writer{in_crash_fd};
+                alignas(LogMessage) static unsigned char storage[sizeof(LogMessage)];
+                while (true) {
+                    auto msg{new (storage) LogMessage};  // Never destroyed: freeing memory isn't allowed in a signal handler.
+                    if (!queue_.TryPop(*msg)) break;
+                    writer.Line(msg->time, LogLevelsStr[static_cast<size_t>(msg->level) % LogLevelsStr.size()], msg->message);
+                }
+            }
+            sink_->FlushOnCrash(in_crash_fd);
+        }
+
+        /// Blocks until everything queued so far is written and flushed.
+        void WaitIdle() {
+            std::unique_lock lock(mut_);
+            flush_requested_ = true;
+            cv_.notify_one();
+            idle_cv_.wait(lock, [this]() { return !flush_requested_ && !busy_ && queue_.SizeApprox() == 0; });
+        }
+
+       private:
+        static size_t RoundUpToPowerOfTwo_(size_t in_value) {
+            size_t result{2};
+            while (result < in_value) result <<= 1;
+            return result;
+        }
+
+        void Push_(const LogMessage& in_msg) {
+            if (queue_.TryPush(in_msg)) return;
+            switch (full_policy_) {
+                case QueueFullPolicy::Block: {
+                    Notify_(false);
+                    // The worker signals idle_cv_ after every pass. The wait is bounded because a pass isn't needed to free a slot, the pop is.
+                    std::unique_lock lock(mut_);
+                    while (!stop_requested_) {
+                        if (queue_.TryPush(in_msg)) return;
+                        idle_cv_.wait_for(lock, kBlockRecheckPeriod);
+                    }
+                    break;  // The worker is stopping and may never pop again.
+                }
+                case QueueFullPolicy::DropNewest:
+                    break;
+                case QueueFullPolicy::OverwriteOldest: {
+                    LogMessage evicted;
+                    do {
+                        if (queue_.TryPop(evicted)) counters_->dropped.fetch_add(1, std::memory_order_relaxed);
+                    } while (!queue_.TryPush(in_msg));
+                    return;
+                }
+            }
+            counters_->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        void Notify_(bool in_flush) {
+            {
+                std::lock_guard lock(mut_);
+                work_requested_ = true;
+                if (in_flush) flush_requested_ = true;
+            }
+            cv_.notify_one();
+            counters_->queue_depth.store(queue_.SizeApprox(), std::memory_order_relaxed);
+        }
+
+        void WorkerLoop_() {
+            std::vector<LogMessage> batch;
+            while (true) {
+                bool flush{false};
+                bool stopping{false};
+                {
+                    std::unique_lock lock(mut_);
+                    cv_.wait(lock, [this]() { return work_requested_ || flush_requested_ || stop_requested_; });
+                    work_requested_ = false;
+                    flush = flush_requested_;
+                    stopping = stop_requested_;
+                    busy_ = true;
+                }
+                LogMessage msg;
+                while (queue_.TryPop(msg)) batch.push_back(std::move(msg));
+                counters_->queue_depth.store(queue_.SizeApprox(), std::memory_order_relaxed);
+                try {
+                    if (!batch.empty()) {
+                        auto begin{std::chrono::steady_clock::now()};
+                        sink_->LogBatch(batch);
+                        counters_->log_latency.Record(std::chrono::steady_clock::now() - begin);
+                        counters_->logged.fetch_add(batch.size(), std::memory_order_relaxed);
+                    }
+                    if (flush || stopping) {
+                        auto begin{std::chrono::steady_clock::now()};
+                        sink_->Flush();
+                        auto latency{std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin)};
+                        counters_->flush_latency.Record(latency);
+                        counters_->last_flush_latency_ns.store(latency.count(), std::memory_order_relaxed);
+                    }
+                } catch (...) {  // A throwing sink must not kill the worker.
+                }
+                batch.clear();
+                {
+                    std::lock_guard lock(mut_);
+                    if (flush) flush_requested_ = false;
+                    busy_ = false;
+                }
+                idle_cv_.notify_all();
+                if (stopping && queue_.SizeApprox() == 0) break;
+            }
+        }
+
+        static constexpr std::chrono::milliseconds kBlockRecheckPeriod{1};
+        std::unique_ptr<BaseSink> sink_;
+        MpmcQueue<LogMessage> queue_;
+        QueueFullPolicy full_policy_;
+        std::shared_ptr<SinkCounters> counters_;
+        std::mutex mut_;
+        std::condition_variable cv_;
+        std::condition_variable idle_cv_;
+        bool work_requested_{false};
+        bool flush_requested_{false};
+        bool stop_requested_{false};
+        bool busy_{false};
+        std::thread worker_;  // Last member: it is started after everything above is constructed.
+    };
+}  // namespace adsvel::log::details
@@ -0,0 +1,198 @@
+/**
+***************************************************************************************************************************************************************
+* @file     deferred_args.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 12:05:31
+* @brief    Binary encoding of log arguments for deferred formatting.
+* @details  Every argument is written as a one byte ArgType tag followed by its value. Scalars are copied as is, strings are copied inline as a
+*           uint32_t length and the characters. The encoding is self-describing, so the logger thread can rebuild the fmt arguments without
+*           knowing the original C++ types.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <fmt/args.h>
+#include <fmt/format.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+namespace adsvel::log::details {
+    constexpr std::size_t kInlineArgsSize{128};  ///< Capacity of the argument buffer of one deferred record.
+
+    enum class ArgType : uint8_t { Bool, Char, Int64, UInt64, Float, Double, String, Pointer };
+
+    /// char[N], e.g. a string literal. It can't be null, unlike a char pointer.
+    template <class T>
+    constexpr bool IsCharArrayArg() {
+        using U = std::remove_cv_t<std::remove_reference_t<T>>;
+        return std::is_array_v<U> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<U>>, char>;
+    }
+
+    template <class T>
+    constexpr bool IsStringArg() {
+        using U = std::decay_t<T>;
+        return IsCharArrayArg<T>() || std::is_same_v<U, char*> || std::is_same_v<U, const char*> || std::is_same_v<U, std::string> || std::is_same_v<U, std::string_view>;
+    }
+
+    template <class T>
+    constexpr bool IsIntegerArg() {
+        using U = std::decay_t<T>;
+        return std::is_integral_v<U> && !std::is_same_v<U, bool> && !std::is_same_v<U, char> && !std::is_same_v<U, wchar_t> && !std::is_same_v<U, char16_t> && !std::is_same_v<U, char32_t> && sizeof(U) <= sizeof(uint64_t);
+    }
+
+    /// True if the argument can be copied into a deferred record, other types are formatted on the caller's thread.
+    template <class T>
+    constexpr bool IsDeferrableArg() {
+        using U = std::decay_t<T>;
+        return std::is_same_v<U, bool> || std::is_same_v<U, char> || IsIntegerArg<T>() || std::is_same_v<U, float> || std::is_same_v<U, double> || IsStringArg<T>() || std::is_same_v<U, void*> || std::is_same_v<U, const void*> ||
+               std::is_same_v<U, std::nullptr_t>;
+    }
+
+    template <class... Args>
+    constexpr bool kAllArgsDeferrable{(IsDeferrableArg<Args>() && ...)};
+
+    class ArgsWriter {
+       public:
+        ArgsWriter(std::byte* in_data, std::size_t in_capacity) : data_{in_data}, capacity_{in_capacity} {}
+
+        template <class T>
+        void Write(const T& in_arg) {
+            using U = std::decay_t<T>;
+            if constexpr (std::is_same_v<U, bool>) {
+                Put_(ArgType::Bool, static_cast<uint8_t>(in_arg));
+            } else if constexpr (std::is_same_v<U, char>) {
+                Put_(ArgType::Char, in_arg);
+            } else if constexpr (IsIntegerArg<T>() && std::is_signed_v<U>) {
+                Put_(ArgType::Int64, static_cast<int64_t>(in_arg));
+            } else if constexpr (IsIntegerArg<T>()) {
+                Put_(ArgType::UInt64, static_cast<uint64_t>(in_arg));
+            } else if constexpr (std::is_same_v<U, float>) {
+                Put_(ArgType::Float, in_arg);
+            } else if constexpr (std::is_same_v<U, double>) {
+                Put_(ArgType::Double, in_arg);
+            } else if constexpr (IsCharArrayArg<T>()) {
+                PutString_(std::string_view{in_arg});
+            } else if constexpr (std::is_same_v<U, char*> || std::is_same_v<U, const char*>) {
+                PutString_(in_arg != nullptr ? std::string_view{in_arg} : std::string_view{});
+            } else if constexpr (IsStringArg<T>()) {
+                PutString_(std::string_view{in_arg});
+            } else {
+                Put_(ArgType::Pointer, reinterpret_cast<uintptr_t>(static_cast<const void*>(in_arg)));
+            }
+        }
+
+        bool Overflow() const { return overflow_; }
+        std::size_t Size() const { return size_; }
+
+       private:
+        void Append_(const void* in_data, std::size_t in_size) {
+            if (overflow_ || size_ + in_size > capacity_) {
+                overflow_ = true;
+                return;
+            }
+            std::memcpy(data_ + size_, in_data, in_size);
+            size_ += in_size;
+        }
+        template <class V>
+        void Put_(ArgType in_type, const V& in_value) {
+            Append_(&in_type, sizeof(in_type));
+            Append_(&in_value, sizeof(in_value));
+        }
+        void PutString_(std::string_view in_str) {
+            auto length{static_cast<uint32_t>(in_str.size())};
+            Put_(ArgType::String, length);
+            Append_(in_str.data(), in_str.size());
+        }
+
+        std::byte* data_;
+        std::size_t capacity_;
+        std::size_t size_{0};
+        bool overflow_{false};
+    };
+
+    /// Encodes the arguments into the buffer. Returns false if they don't fit.
+    template <class... Args>
+    bool EncodeArgs(std::byte* out_data, std::size_t in_capacity, std::size_t& out_size, const Args&... in_args) {
+        ArgsWriter writer{out_data, in_capacity};
+        (writer.Write(in_args), ...);
+        out_size = writer.Size();
+        return !writer.Overflow();
+    }
+
+    /// Calls in_visitor with every argument of an encoded buffer as bool, char, int64_t, uint64_t, float, double, std::string_view or const void*.
+    /// Strings refer to the buffer.
+    template <class Visitor>
+    void ForEachArg(const std::byte* in_data, std::size_t in_size, Visitor&& in_visitor) {
+        std::size_t pos{0};
+        auto read = [&](void* out_value, std::size_t in_value_size) {
+            if (pos + in_value_size > in_size) throw std::out_of_range("Truncated deferred log arguments.");
+            std::memcpy(out_value, in_data + pos, in_value_size);
+            pos += in_value_size;
+        };
+        while (pos < in_size) {
+            ArgType type;
+            read(&type, sizeof(type));
+            switch (type) {
+                case ArgType::Bool: {
+                    uint8_t value;
+                    read(&value, sizeof(value));
+                    in_visitor(value != 0);
+                } break;
+                case ArgType::Char: {
+                    char value;
+                    read(&value, sizeof(value));
+                    in_visitor(value);
+                } break;
+                case ArgType::Int64: {
+                    int64_t value;
+                    read(&value, sizeof(value));
+                    in_visitor(value);
+                } break;
+                case ArgType::UInt64: {
+                    uint64_t value;
+                    read(&value, sizeof(value));
+                    in_visitor(value);
+                } break;
+                case ArgType::Float: {
+                    float value;
+                    read(&value, sizeof(value));
+                    in_visitor(value);
+                } break;
+                case ArgType::Double: {
+                    double value;
+                    read(&value, sizeof(value));
+                    in_visitor(value);
+                } break;
+                case ArgType::String: {
+                    uint32_t length;
+                    read(&length, sizeof(length));
+                    if (pos + length > in_size) throw std::out_of_range("Truncated deferred log arguments.");
+                    in_visitor(std::string_view{reinterpret_cast<const char*>(in_data + pos), length});
+                    pos += length;
+                } break;
+                case ArgType::Pointer: {
+                    uintptr_t value;
+                    read(&value, sizeof(value));
+                    in_visitor(reinterpret_cast<const void*>(value));
+                } break;
+                default:
+                    throw std::invalid_argument("Unknown deferred log argument type.");
+            }
+        }
+    }
+
+    /// Rebuilds the fmt arguments from an encoded buffer. String arguments refer to the buffer, so it must outlive the store.
+    inline void DecodeArgs(const std::byte* in_data, std::size_t in_size, fmt::dynamic_format_arg_store<fmt::format_context>& out_store) {
+        ForEachArg(in_data, in_size, [&](auto in_value) {
+            if constexpr (std::is_same_v<decltype(in_value), std::string_view>) {
+                out_store.push_back(fmt::string_view{in_value.data(), in_value.size()});  // A std::string_view would be copied by the store.
+            } else {
+                out_store.push_back(in_value);
+            }
+        });
+    }
+}  // namespace adsvel::log::details
@@ -0,0 +1,165 @@
+/**
+***************************************************************************************************************************************************************
+* @file     fields.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     18.10.2026 01:26:03
+* @brief    Structured message fields: key/value pairs, source location and thread id.
+* @details  Fields are written in the deferred arguments encoding (deferred_args.h) as alternating key and value arguments, so a record
+*           carries all of them in one flat buffer: the inline argument buffer of the LogRecord when they fit, the tail of its message string
+*           otherwise. Values that can't be encoded are formatted with "{}" and stored as strings.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "deferred_args.h"
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <functional>
+#include <thread>
+#endif
+namespace adsvel::log {
+    /// Where a message was logged. The strings come from __FILE__ and __func__, so they have static storage.
+    struct SourceLocation {
+        const char* file{nullptr};
+        const char* function{nullptr};
+        uint32_t line{0};
+    };
+
+    /// Key/value pair of a structured message, see Logger::LogKv(). Refers to its value, so it only lives within the call.
+    template <class T>
+    struct Field {
+        std::string_view key;
+        const T& value;
+    };
+    template <class T>
+    Field<T> Kv(std::string_view in_key, const T& in_value) {
+        return Field<T>{in_key, in_value};
+    }
+}  // namespace adsvel::log
+
+/// Source location of the statement, for Logger::Log() and Logger::LogKv().
+#define ADSVEL_LOG_HERE (::adsvel::log::SourceLocation{__FILE__, __func__, static_cast<uint32_t>(__LINE__)})
+
+namespace adsvel::log::details {
+    /// Id of the calling thread as shown by the OS (the TID on Linux), cached per thread.
+    inline uint64_t CurrentThreadId() {
+#ifdef __linux__
+        thread_local uint64_t id{static_cast<uint64_t>(syscall(SYS_gettid))};
+#else
+        thread_local uint64_t id{std::hash<std::thread::id>{}(std::this_thread::get_id())};
+#endif
+        return id;
+    }
+
+    template <class T>
+    void WriteField(ArgsWriter& io_writer, const Field<T>& in_field) {
+        io_writer.Write(in_field.key);
+        if constexpr (IsDeferrableArg<T>()) {
+            io_writer.Write(in_field.value);
+        } else {
+            io_writer.Write(fmt::format("{}", in_field.value));
+        }
+    }
+
+    /// Encodes the fields into the buffer. Returns false if they don't fit.
+    template <class... Ts>
+    bool EncodeFields(std::byte* out_data, std::size_t in_capacity, std::size_t& out_size, const Field<Ts>&... in_fields) {
+        ArgsWriter writer{out_data, in_capacity};
+        (WriteField(writer, in_fields), ...);
+        out_size = writer.Size();
+        return !writer.Overflow();
+    }
+
+    /// Appends the encoded fields to out_text, for the ones that don't fit into the inline buffer of a record.
+    template <class... Ts>
+    void EncodeFields(std::string& out_text, const Field<Ts>&... in_fields) {
+        std::vector<std::byte> buffer(256);
+        std::size_t size{0};
+        while (!EncodeFields(buffer.data(), buffer.size(), size, in_fields...)) buffer.resize(buffer.size() * 2);
+        out_text.append(reinterpret_cast<const char*>(buffer.data()), size);
+    }
+
+    /// Calls in_visitor(key, value) for every field of LogMessage::fields, the value has one of the ForEachArg() types.
+    template <class Visitor>
+    void ForEachField(std::string_view in_fields, Visitor&& in_visitor) {
+        std::string_view key;
+        bool is_key{true};
+        ForEachArg(reinterpret_cast<const std::byte*>(in_fields.data()), in_fields.size(), [&](auto in_value) {
+            if (is_key) {
+                if constexpr (std::is_same_v<decltype(in_value), std::string_view>) {
+                    key = in_value;
+                } else {
+                    throw std::invalid_argument("A structured field key must be a string.");
+                }
+            } else {
+                in_visitor(key, in_value);
+            }
+            is_key = !is_key;
+        });
+    }
+
+    /// Appends in_text in double quotes with '"', '\\' and the control characters escaped as in JSON, everything else (UTF-8 included) is copied in runs.
+    inline void AppendQuoted(fmt::memory_buffer& out_buffer, std::string_view in_text) {
+        auto append = [&](std::string_view in_part) { out_buffer.append(in_part.data(), in_part.data() + in_part.size()); };
+        out_buffer.push_back('"');
+        size_t run{0};
+        for (size_t i{0}; i < in_text.size(); i++) {
+            auto c{static_cast<unsigned char>(in_text[i])};
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            append(in_text.substr(run, i - run));
+            run = i + 1;
+            switch (c) {
+                case '"': append("\\\""); break;
+                case '\\': append("\\\\"); break;
+                case '\n': append("\\n"); break;
+                case '\r': append("\\r"); break;
+                case '\t': append("\\t"); break;
+                case '\b': append("\\b"); break;
+                case '\f': append("\\f"); break;
+                default: {
+                    char escaped[]{'\\', 'u', '0', '0', "0123456789abcdef"[c >> 4], "0123456789abcdef"[c & 0xF]};
+                    append({escaped, sizeof(escaped)});
+                }
+            }
+        }
+        append(in_text.substr(run));
+        out_buffer.push_back('"');
+    }
+
+    /// Appends " key=value" for every field, the form the text sinks use. Strings that are empty or hold spaces, '=', quotes, backslashes or
+    /// control characters are quoted with AppendQuoted(), so a value can't split the line or fake another field.
+    inline void AppendFieldsText(fmt::memory_buffer& out_buffer, std::string_view in_fields) {
+        if (in_fields.empty()) return;
+        auto append_text = [&](std::string_view in_key, std::string_view in_value) {
+            fmt::format_to(std::back_inserter(out_buffer), " {}=", in_key);
+            bool plain{!in_value.empty() && std::none_of(in_value.begin(), in_value.end(), [](char c) { return static_cast<unsigned char>(c) <= ' ' || c == '=' || c == '"' || c == '\\'; })};
+            if (plain) {
+                out_buffer.append(in_value.data(), in_value.data() + in_value.size());
+            } else {
+                AppendQuoted(out_buffer, in_value);
+            }
+        };
+        try {
+            ForEachField(in_fields, [&](std::string_view in_key, auto in_value) {
+                if constexpr (std::is_same_v<decltype(in_value), std::string_view>) {
+                    append_text(in_key, in_value);
+                } else if constexpr (std::is_same_v<decltype(in_value), char>) {
+                    append_text(in_key, {&in_value, 1});
+                } else {
+                    fmt::format_to(std::back_inserter(out_buffer), " {}={}", in_key, in_value);
+                }
+            });
+        } catch (const std::exception& e) {
+            fmt::format_to(std::back_inserter(out_buffer), " (broken fields: {})", e.what());
+        }
+    }
+}  // namespace adsvel::log::details
@@ -0,0 +1,123 @@
+/**
+***************************************************************************************************************************************************************
+* @file     log_clock.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 16:05:44
+* @brief    Clock used for LogMessage::time.
+* @details  ClockSource::System calls system_clock::now() for every message. ClockSource::Tsc reads the CPU time stamp counter and converts it
+*           to wall time with a linear calibration against system_clock. The logger thread calls Calibrate() on every pass, the calibration
+*           itself runs once per kCalibrationPeriod and is published to the producers through a seqlock, so reading the clock never takes a lock.
+*           Without an invariant TSC (CPUID 0x80000007 EDX bit 8, the counter keeps its rate across P- and C-states) or off x86 the
+*           steady_clock ticks are used instead. SetSource() may be called at any time, it and the calibration are serialized by a mutex the
+*           logger thread only tries to take.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+namespace adsvel::log {
+    enum class ClockSource : uint8_t { System, Tsc };
+}  // namespace adsvel::log
+
+namespace adsvel::log::details {
+    class LogClock {
+       public:
+        static std::chrono::system_clock::time_point Now() {
+            if (source_.load(std::memory_order_relaxed) == ClockSource::System) return std::chrono::system_clock::now();
+            int64_t ticks{ReadTicks_()};
+            while (true) {
+                uint32_t seq{sequence_.load(std::memory_order_acquire)};
+                if (seq & 1U) continue;  // Calibration in progress.
+                int64_t base_ticks{base_ticks_.load(std::memory_order_relaxed)};
+                int64_t base_ns{base_ns_.load(std::memory_order_relaxed)};
+                double ns_per_tick{ns_per_tick_.load(std::memory_order_relaxed)};
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence_.load(std::memory_order_relaxed) != seq) continue;
+                auto ns{base_ns + static_cast<int64_t>(static_cast<double>(ticks - base_ticks) * ns_per_tick)};
+                return std::chrono::system_clock::time_point{std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{ns})};
+            }
+        }
+
+        /// Switches the clock source. Enabling Tsc takes an initial calibration of about kInitialCalibrationTime.
+        static void SetSource(ClockSource in_source) {
+            std::lock_guard lock(mut_);
+            if (in_source == ClockSource::Tsc) {
+                use_tsc_.store(HasInvariantTsc_(), std::memory_order_relaxed);
+                auto [anchor_ticks, anchor_ns]{Sample_()};
+                std::this_thread::sleep_for(kInitialCalibrationTime);
+                auto [ticks, ns]{Sample_()};
+                anchor_ticks_ = anchor_ticks;
+                anchor_ns_ = anchor_ns;
+                Publish_(ticks, ns, static_cast<double>(ns - anchor_ns) / static_cast<double>(ticks - anchor_ticks));
+                last_calibration_ = std::chrono::steady_clock::now();
+            }
+            source_.store(in_source, std::memory_order_relaxed);
+        }
+        static ClockSource GetSource() { return source_.load(std::memory_order_relaxed); }
+
+        /// Refines the tick rate over the whole time since SetSource() and re-anchors it to system_clock. Skipped while SetSource() runs.
+        static void Calibrate() {
+            if (source_.load(std::memory_order_relaxed) != ClockSource::Tsc) return;
+            std::unique_lock lock(mut_, std::try_to_lock);
+            if (!lock.owns_lock()) return;
+            if (std::chrono::steady_clock::now() - last_calibration_ < kCalibrationPeriod) return;
+            last_calibration_ = std::chrono::steady_clock::now();
+            auto [ticks, ns]{Sample_()};
+            if (ticks <= anchor_ticks_ || ns <= anchor_ns_) return;
+            Publish_(ticks, ns, static_cast<double>(ns - anchor_ns_) / static_cast<double>(ticks - anchor_ticks_));
+        }
+
+       private:
+        static int64_t ReadTicks_() {
+#if defined(__x86_64__) || defined(__i386__)
+            if (use_tsc_.load(std::memory_order_relaxed)) return static_cast<int64_t>(__rdtsc());
+#endif
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+        static bool HasInvariantTsc_() {
+#if defined(__x86_64__) || defined(__i386__)
+            unsigned int eax{0}, ebx{0}, ecx{0}, edx{0};
+            if (__get_cpuid(0x80000000U, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007U) return false;
+            if (__get_cpuid(0x80000007U, &eax, &ebx, &ecx, &edx) == 0) return false;
+            return (edx & (1U << 8)) != 0;
+#else
+            return false;
+#endif
+        }
+        static std::pair<int64_t, int64_t> Sample_() {
+            auto ticks{ReadTicks_()};
+            auto ns{std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()};
+            return {ticks, ns};
+        }
+        static void Publish_(int64_t in_ticks, int64_t in_ns, double in_ns_per_tick) {
+            sequence_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            base_ticks_.store(in_ticks, std::memory_order_relaxed);
+            base_ns_.store(in_ns, std::memory_order_relaxed);
+            ns_per_tick_.store(in_ns_per_tick, std::memory_order_relaxed);
+            sequence_.fetch_add(1, std::memory_order_release);
+        }
+
+        static constexpr std::chrono::milliseconds kInitialCalibrationTime{10};
+        static constexpr std::chrono::seconds kCalibrationPeriod{1};
+        static std::atomic<ClockSource> source_;
+        static std::atomic<bool> use_tsc_;  ///< Ticks come from rdtsc rather than steady_clock.
+        static std::mutex mut_;              ///< Held by SetSource() and Calibrate(), guards the anchor, the calibration time and Publish_().
+        static std::atomic<uint32_t> sequence_;
+        static std::atomic<int64_t> base_ticks_;
+        static std::atomic<int64_t> base_ns_;
+        static std::atomic<double> ns_per_tick_;
+        static int64_t anchor_ticks_;
+        static int64_t anchor_ns_;
+        static std::chrono::steady_clock::time_point last_calibration_;
+    };
+}  // namespace adsvel::log::details
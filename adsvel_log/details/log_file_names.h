@@ -0,0 +1,106 @@
+/**
+***************************************************************************************************************************************************************
+* @file     log_file_names.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 17:10:23
+* @brief    Numbering of rotated log files ("LOG {}.txt" -> "LOG 1.txt" ... "LOG 9999.txt").
+* @details  Files are numbered from kFirstNumberOfLogFile to kMaxNumberOfLogFile and the numbering wraps around. Existing files are found
+*           with a single pass over the directory instead of an exists() call per possible number.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+namespace adsvel::log::details {
+    class LogFileNames {
+       public:
+        struct ExistingFile {
+            size_t number;
+            uintmax_t size;
+            bool compressed{false};  ///< The file has kCompressedSuffix appended, see SegmentCompressor.
+        };
+
+        static constexpr uint16_t kMaxNumberOfLogFile{9999};
+        static constexpr uint16_t kMaxAmountOfLogFile{5000};
+        static constexpr uint16_t kFirstNumberOfLogFile{1};
+        static constexpr std::string_view kCompressedSuffix{".zst"};
+
+        explicit LogFileNames(std::string in_pattern) : pattern_{std::move(in_pattern)} {
+            std::filesystem::path probe{Make(kFirstNumberOfLogFile)};
+            directory_ = probe.has_parent_path() ? probe.parent_path() : std::filesystem::path{"."};
+        }
+
+        std::string Make(size_t in_number) const { return fmt::format(pattern_, in_number); }
+        const std::string& GetPattern() const { return pattern_; }
+
+        static size_t Next(size_t in_number) { return in_number >= kMaxNumberOfLogFile ? kFirstNumberOfLogFile : in_number + 1; }
+        /// Number of the file that falls out of the retention window when in_number becomes current.
+        static size_t Expired(size_t in_number, size_t in_amount_of_log_files) {
+            auto span{static_cast<long>(kMaxNumberOfLogFile)};
+            auto expired{static_cast<long>(in_number) - static_cast<long>(in_amount_of_log_files)};
+            if (expired < kFirstNumberOfLogFile) expired += span;
+            return static_cast<size_t>(expired);
+        }
+
+        /// All log files of the pattern in one directory scan, sorted by number, compressed ones included. Errors (missing directory,
+        /// no access) give an empty list.
+        std::vector<ExistingFile> Scan() const {
+            std::vector<ExistingFile> files;
+            std::error_code ec;
+            std::filesystem::directory_iterator it{directory_, ec};
+            if (ec) return files;
+            for (; it != std::filesystem::directory_iterator{}; it.increment(ec)) {
+                if (ec) break;
+                auto file_name{it->path().filename().string()};
+                bool compressed{file_name.size() > kCompressedSuffix.size() && file_name.compare(file_name.size() - kCompressedSuffix.size(), kCompressedSuffix.size(), kCompressedSuffix) == 0};
+                if (compressed) file_name.resize(file_name.size() - kCompressedSuffix.size());
+                auto number{Parse_(file_name)};
+                if (number == 0) continue;
+                std::error_code size_ec;
+                auto size{it->file_size(size_ec)};
+                if (size_ec) continue;
+                files.push_back({number, size, compressed});
+            }
+            std::sort(files.begin(), files.end(), [](const ExistingFile& a, const ExistingFile& b) { return a.number < b.number; });
+            return files;
+        }
+
+        /// The most recent file of a scan. Once the numbering has wrapped (the last number exists) the newest file is the highest one in
+        /// the lower half, the same rule the original exists() search used. Returns nullptr if there are no files.
+        static const ExistingFile* Newest(const std::vector<ExistingFile>& in_files) {
+            if (in_files.empty()) return nullptr;
+            if (in_files.back().number == kMaxNumberOfLogFile) {
+                const ExistingFile* newest{&in_files.back()};
+                for (auto& file : in_files) {
+                    if (file.number <= kMaxAmountOfLogFile) newest = &file;
+                }
+                return newest;
+            }
+            return &in_files.back();
+        }
+
+       private:
+        /// File number from a file name, 0 if the name doesn't belong to the pattern.
+        size_t Parse_(const std::string& in_file_name) const {
+            auto begin{in_file_name.find_first_of("0123456789")};
+            while (begin != std::string::npos) {
+                auto end{in_file_name.find_first_not_of("0123456789", begin)};
+                auto number{std::strtoul(in_file_name.c_str() + begin, nullptr, 10)};
+                if (number >= kFirstNumberOfLogFile && number <= kMaxNumberOfLogFile && std::filesystem::path{Make(number)}.filename().string() == in_file_name) return number;
+                begin = in_file_name.find_first_of("0123456789", end);
+            }
+            return 0;
+        }
+
+        std::string pattern_;
+        std::filesystem::path directory_;
+    };
+}  // namespace adsvel::log::details
@@ -0,0 +1,126 @@
+/**
+***************************************************************************************************************************************************************
+* @file     metrics.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 22:31:50
+* @brief    Counters and histograms behind Logger::GetMetrics().
+* @details  Every counter here has a single writer, so it is updated with a relaxed load and store instead of a locked read-modify-write and
+*           read from any thread without a lock. Producer counters are per thread (ThreadCounters) and summed on read; the counters of a
+*           finished thread are folded into ThreadCountersRegistry so nothing is lost.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "mpmc_queue.h"
+namespace adsvel::log {
+    /// Copy of a details::LatencyHistogram. Bucket i counts durations in [2^i, 2^(i+1)) ns, bucket 0 also takes 0 ns.
+    struct HistogramSnapshot {
+        static constexpr size_t kBuckets{40};
+        std::array<uint64_t, kBuckets> counts{};
+        uint64_t count{0};
+        std::chrono::nanoseconds max{0};
+
+        /// Upper bound of the bucket holding the in_fraction quantile, so the result is within a factor of two.
+        std::chrono::nanoseconds Percentile(double in_fraction) const {
+            auto rank{static_cast<uint64_t>(in_fraction * static_cast<double>(count))};
+            uint64_t seen{0};
+            for (size_t i{0}; i < kBuckets; i++) {
+                seen += counts[i];
+                if (seen > rank) return std::min(std::chrono::nanoseconds{(int64_t{2} << i) - 1}, max);
+            }
+            return max;
+        }
+    };
+}  // namespace adsvel::log
+
+namespace adsvel::log::details {
+    /// Increment of a counter that only one thread writes.
+    inline void BumpCounter(std::atomic<uint64_t>& io_counter, uint64_t in_value = 1) { io_counter.store(io_counter.load(std::memory_order_relaxed) + in_value, std::memory_order_relaxed); }
+
+    class LatencyHistogram {
+       public:
+        void Record(std::chrono::nanoseconds in_duration) {
+            auto ns{static_cast<uint64_t>(std::max<int64_t>(in_duration.count(), 0))};
+            size_t bucket{ns < 2 ? 0 : std::min<size_t>(63 - __builtin_clzll(ns), HistogramSnapshot::kBuckets - 1)};
+            BumpCounter(counts_[bucket]);
+            BumpCounter(count_);
+            if (ns > max_ns_.load(std::memory_order_relaxed)) max_ns_.store(ns, std::memory_order_relaxed);
+        }
+        HistogramSnapshot Snapshot() const {
+            HistogramSnapshot snapshot;
+            for (size_t i{0}; i < counts_.size(); i++) snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+            snapshot.count = count_.load(std::memory_order_relaxed);
+            snapshot.max = std::chrono::nanoseconds{max_ns_.load(std::memory_order_relaxed)};
+            return snapshot;
+        }
+
+       private:
+        std::array<std::atomic<uint64_t>, HistogramSnapshot::kBuckets> counts_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> max_ns_{0};
+    };
+
+    /// What a sink reports about its own output, see BaseSink::GetIoCounters(). Written by the thread that runs the sink.
+    struct SinkIoCounters {
+        std::atomic<uint64_t> bytes_written{0};
+        std::atomic<uint64_t> rotations{0};
+        std::atomic<uint64_t> open_attempts{0};  ///< Attempts to (re)open the output after it was unavailable, successful or not.
+        std::atomic<uint64_t> dropped{0};        ///< Messages the sink lost itself, e.g. its delayed write buffer overflowed.
+    };
+
+    /// Counters of one producer thread, on their own cache line so producers never share one.
+    struct alignas(kCacheLineSize) ThreadCounters {
+        std::atomic<uint64_t> enqueued{0};
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    class ThreadCountersRegistry {
+       public:
+        struct Totals {
+            uint64_t enqueued{0};
+            uint64_t dropped{0};
+        };
+
+        /// Counters of the calling thread, registered on the first call.
+        static ThreadCounters& Local() {
+            thread_local Registration registration;
+            return *registration.counters;
+        }
+        static Totals Sum() {
+            std::lock_guard lock(mut_);
+            Totals totals{retired_};
+            for (auto& counters : threads_) {
+                totals.enqueued += counters->enqueued.load(std::memory_order_relaxed);
+                totals.dropped += counters->dropped.load(std::memory_order_relaxed);
+            }
+            return totals;
+        }
+
+       private:
+        struct Registration {
+            Registration() : counters{std::make_shared<ThreadCounters>()} {
+                std::lock_guard lock(mut_);
+                threads_.push_back(counters);
+            }
+            ~Registration() {
+                std::lock_guard lock(mut_);
+                retired_.enqueued += counters->enqueued.load(std::memory_order_relaxed);
+                retired_.dropped += counters->dropped.load(std::memory_order_relaxed);
+                threads_.erase(std::remove(threads_.begin(), threads_.end(), counters), threads_.end());
+            }
+            std::shared_ptr<ThreadCounters> counters;
+        };
+
+        static std::mutex mut_;
+        static std::vector<std::shared_ptr<ThreadCounters>> threads_;
+        static Totals retired_;  ///< Counters of the threads that have exited.
+    };
+}  // namespace adsvel::log::details
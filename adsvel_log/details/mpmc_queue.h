@@ -0,0 +1,90 @@
+/**
+***************************************************************************************************************************************************************
+* @file     mpmc_queue.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 10:12:40
+* @brief    Bounded lock-free multi-producer queue.
+* @details  Dmitry Vyukov's bounded MPMC queue. Every cell carries a sequence number, so producers only compete on one CAS of enqueue_pos_ and
+*           never take a lock. The consumer side is also safe for several threads, which lets a producer evict the oldest element itself
+*           (QueueFullPolicy::OverwriteOldest) without coordinating with the logger thread.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+namespace adsvel::log::details {
+    constexpr std::size_t kCacheLineSize{64};
+
+    template <class T>
+    class MpmcQueue {
+       public:
+        explicit MpmcQueue(std::size_t in_capacity) : buffer_{new Cell[in_capacity]}, mask_{in_capacity - 1} {
+            if (in_capacity < 2 || (in_capacity & (in_capacity - 1)) != 0) throw std::invalid_argument("MpmcQueue capacity must be a power of two.");
+            for (std::size_t i{0}; i < in_capacity; i++) buffer_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        MpmcQueue(const MpmcQueue&) = delete;
+        MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+        template <class U>
+        bool TryPush(U&& in_value) {
+            Cell* cell{nullptr};
+            std::size_t pos{enqueue_pos_.load(std::memory_order_relaxed)};
+            while (true) {
+                cell = &buffer_[pos & mask_];
+                std::size_t seq{cell->sequence.load(std::memory_order_acquire)};
+                auto diff{static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos)};
+                if (diff == 0) {
+                    if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    return false;  // Full.
+                } else {
+                    pos = enqueue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data = std::forward<U>(in_value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPop(T& out_value) {
+            Cell* cell{nullptr};
+            std::size_t pos{dequeue_pos_.load(std::memory_order_relaxed)};
+            while (true) {
+                cell = &buffer_[pos & mask_];
+                std::size_t seq{cell->sequence.load(std::memory_order_acquire)};
+                auto diff{static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1)};
+                if (diff == 0) {
+                    if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    return false;  // Empty.
+                } else {
+                    pos = dequeue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+            out_value = std::move(cell->data);
+            cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::size_t Capacity() const { return mask_ + 1; }
+        std::size_t SizeApprox() const {
+            auto enq{enqueue_pos_.load(std::memory_order_relaxed)};
+            auto deq{dequeue_pos_.load(std::memory_order_relaxed)};
+            return enq > deq ? enq - deq : 0;
+        }
+
+       private:
+        struct Cell {
+            std::atomic<std::size_t> sequence{0};
+            T data{};
+        };
+        std::unique_ptr<Cell[]> buffer_;
+        const std::size_t mask_;
+        alignas(kCacheLineSize) std::atomic<std::size_t> enqueue_pos_{0};
+        alignas(kCacheLineSize) std::atomic<std::size_t> dequeue_pos_{0};
+    };
+}  // namespace adsvel::log::details
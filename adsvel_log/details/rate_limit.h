@@ -0,0 +1,61 @@
+/**
+***************************************************************************************************************************************************************
+* @file     rate_limit.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     18.10.2026 00:41:27
+* @brief    Per call site limiters behind ADSVEL_LOG_EVERY_N, ADSVEL_LOG_FIRST_N and ADSVEL_LOG_RATE_LIMITED.
+* @details  Each macro expands to a function-local static limiter. The limiters are constant-initialized, so there is no initialization guard,
+*           and a rejected call costs one atomic operation (plus a steady_clock read for TokenBucket) before anything is formatted.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+namespace adsvel::log::details {
+    /// Lets through the 1st, (N+1)-th, (2N+1)-th... call.
+    class EveryN {
+       public:
+        constexpr EveryN() = default;
+        bool Allow(uint64_t in_n) { return count_.fetch_add(1, std::memory_order_relaxed) % std::max<uint64_t>(in_n, 1) == 0; }
+
+       private:
+        std::atomic<uint64_t> count_{0};
+    };
+
+    /// Lets through the first N calls only.
+    class FirstN {
+       public:
+        constexpr FirstN() = default;
+        bool Allow(uint64_t in_n) {
+            if (count_.load(std::memory_order_relaxed) >= in_n) return false;  // No write once the limit is reached.
+            return count_.fetch_add(1, std::memory_order_relaxed) < in_n;
+        }
+
+       private:
+        std::atomic<uint64_t> count_{0};
+    };
+
+    /// Token bucket in its GCRA form: a single "theoretical arrival time" instead of a token count and a refill time, so it is updated by one CAS.
+    class TokenBucket {
+       public:
+        constexpr TokenBucket() = default;
+        /// in_rate calls per second on average, up to in_burst at once.
+        bool Allow(double in_rate, uint64_t in_burst) {
+            auto now{std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()};
+            auto interval{static_cast<int64_t>(1e9 / std::max(in_rate, 1e-9))};
+            auto tolerance{interval * static_cast<int64_t>(std::max<uint64_t>(in_burst, 1) - 1)};
+            auto arrival{arrival_ns_.load(std::memory_order_relaxed)};
+            while (true) {
+                auto start{std::max(arrival, now)};
+                if (start - now > tolerance) return false;
+                if (arrival_ns_.compare_exchange_weak(arrival, start + interval, std::memory_order_relaxed)) return true;
+            }
+        }
+
+       private:
+        std::atomic<int64_t> arrival_ns_{0};
+    };
+}  // namespace adsvel::log::details
@@ -0,0 +1,185 @@
+/**
+***************************************************************************************************************************************************************
+* @file     segment_compressor.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 21:14:37
+* @brief    Background compression of closed log files.
+* @details  FileSink hands every file it rotates away from to SegmentCompressor. A low priority worker thread streams it through zstd into
+*           "<name>.zst" (a regular zstd frame with a checksum, readable by zstdcat) and removes the original. After every job the worker applies
+*           the retention: files are deleted from the oldest one while all files of the pattern together take more than the byte budget, so the
+*           number of kept files grows with the compression ratio. The file being written is never touched.
+*           Compression is available when the library is built with ADSVEL_LOG_HAS_ZSTD (see CMakeLists.txt).
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "log_file_names.h"
+#ifdef ADSVEL_LOG_HAS_ZSTD
+#include <zstd.h>
+#endif
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+namespace adsvel::log {
+    enum class FileCompression : uint8_t { None, Zstd };
+}  // namespace adsvel::log
+
+namespace adsvel::log::details {
+#ifdef ADSVEL_LOG_HAS_ZSTD
+    constexpr bool kZstdAvailable{true};
+#else
+    constexpr bool kZstdAvailable{false};
+#endif
+
+    class SegmentCompressor {
+       public:
+        /// in_budget is the number of bytes all files of the pattern may take on disk, compressed or not.
+        SegmentCompressor(LogFileNames in_file_names, uintmax_t in_budget, int in_level = kDefaultLevel)
+            : file_names_{std::move(in_file_names)}, budget_{in_budget}, level_{in_level}, worker_{[this]() { WorkerLoop_(); }} {}
+        ~SegmentCompressor() {
+            {
+                std::lock_guard lock(mut_);
+                stop_requested_ = true;
+            }
+            cv_.notify_one();
+            worker_.join();  // Files still in the queue stay uncompressed and are picked up by the next run.
+        }
+
+        /// Queues closed files for compression. in_current is the file being written, it is protected from the retention.
+        void Submit(const std::vector<size_t>& in_numbers, size_t in_current) {
+            {
+                std::lock_guard lock(mut_);
+                jobs_.insert(jobs_.end(), in_numbers.begin(), in_numbers.end());
+                current_ = in_current;
+                retention_requested_ = true;
+            }
+            cv_.notify_one();
+        }
+
+        static constexpr int kDefaultLevel{3};
+
+       private:
+        void WorkerLoop_() {
+#ifdef __linux__
+            setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);  // Only this thread, Linux has per-thread nice values.
+#endif
+            while (true) {
+                size_t job{0};
+                size_t current{0};
+                bool has_job{false};
+                {
+                    std::unique_lock lock(mut_);
+                    cv_.wait(lock, [this]() { return stop_requested_ || retention_requested_ || !jobs_.empty(); });
+                    if (stop_requested_) return;
+                    current = current_;
+                    if (!jobs_.empty()) {
+                        job = jobs_.front();
+                        jobs_.pop_front();
+                        has_job = true;
+                    }
+                    retention_requested_ = false;
+                }
+                try {
+                    if (has_job) CompressFile_(file_names_.Make(job));
+                    EnforceRetention_(current);
+                } catch (...) {  // The disk may be full or gone, the next rotation retries.
+                }
+            }
+        }
+
+        void CompressFile_(const std::filesystem::path& in_path) {
+#ifdef ADSVEL_LOG_HAS_ZSTD
+            std::ifstream input(in_path, std::ifstream::binary);
+            if (!input) return;
+            auto compressed{in_path.string() + std::string(LogFileNames::kCompressedSuffix)};
+            auto temporary{compressed + ".tmp"};
+            std::ofstream output(temporary, std::ofstream::binary | std::ofstream::trunc);
+            if (!output) return;
+            if (context_ == nullptr) context_.reset(ZSTD_createCCtx());
+            ZSTD_CCtx_reset(context_.get(), ZSTD_reset_session_only);
+            ZSTD_CCtx_setParameter(context_.get(), ZSTD_c_compressionLevel, level_);
+            ZSTD_CCtx_setParameter(context_.get(), ZSTD_c_checksumFlag, 1);
+            in_buffer_.resize(ZSTD_CStreamInSize());
+            out_buffer_.resize(ZSTD_CStreamOutSize());
+
+            bool finished{false};
+            while (!finished) {
+                input.read(in_buffer_.data(), static_cast<std::streamsize>(in_buffer_.size()));
+                bool last{input.eof()};
+                if (input.bad()) break;
+                ZSTD_inBuffer in{in_buffer_.data(), static_cast<size_t>(input.gcount()), 0};
+                auto mode{last ? ZSTD_e_end : ZSTD_e_continue};
+                bool drained{false};
+                while (!drained) {
+                    ZSTD_outBuffer out{out_buffer_.data(), out_buffer_.size(), 0};
+                    auto remaining{ZSTD_compressStream2(context_.get(), &out, &in, mode)};
+                    if (ZSTD_isError(remaining)) break;
+                    output.write(out_buffer_.data(), static_cast<std::streamsize>(out.pos));
+                    drained = last ? remaining == 0 : in.pos == in.size;
+                }
+                if (!drained || !output) break;
+                finished = last;
+            }
+            output.close();
+            std::error_code ec;
+            if (!finished || output.fail()) {
+                std::filesystem::remove(temporary, ec);
+                return;
+            }
+            std::filesystem::rename(temporary, compressed, ec);
+            if (!ec) std::filesystem::remove(in_path, ec);
+#else
+            (void)in_path;
+#endif
+        }
+
+        /// Deletes files from the oldest one until the rest fits into the budget. The numbering wraps, so the age is counted back from the
+        /// current file. The count is also kept within kMaxAmountOfLogFile, LogFileNames::Newest() relies on it after a wrap.
+        void EnforceRetention_(size_t in_current) {
+            auto files{file_names_.Scan()};
+            auto span{static_cast<size_t>(LogFileNames::kMaxNumberOfLogFile)};
+            auto age = [&](const LogFileNames::ExistingFile& file) { return (in_current + span - file.number) % span; };
+            std::stable_sort(files.begin(), files.end(), [&](auto& a, auto& b) { return age(a) < age(b); });
+            uintmax_t total{0};
+            size_t kept{0};
+            for (auto& file : files) {
+                total += file.size;
+                kept++;
+                if (file.number == in_current || (total <= budget_ && kept <= LogFileNames::kMaxAmountOfLogFile)) continue;
+                auto name{file_names_.Make(file.number)};
+                std::error_code ec;
+                std::filesystem::remove(file.compressed ? name + std::string(LogFileNames::kCompressedSuffix) : name, ec);
+            }
+        }
+
+#ifdef ADSVEL_LOG_HAS_ZSTD
+        struct ContextDeleter {
+            void operator()(ZSTD_CCtx* in_context) const { ZSTD_freeCCtx(in_context); }
+        };
+        std::unique_ptr<ZSTD_CCtx, ContextDeleter> context_{};
+#endif
+        LogFileNames file_names_;
+        uintmax_t budget_;
+        int level_;
+        std::vector<char> in_buffer_{};
+        std::vector<char> out_buffer_{};
+        std::mutex mut_;
+        std::condition_variable cv_;
+        std::deque<size_t> jobs_{};
+        size_t current_{0};
+        bool retention_requested_{false};
+        bool stop_requested_{false};
+        std::thread worker_;  // Last member: it is started after everything above is constructed.
+    };
+}  // namespace adsvel::log::details
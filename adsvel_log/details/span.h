@@ -0,0 +1,36 @@
+/**
+***************************************************************************************************************************************************************
+* @file     span.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 14:20:05
+* @brief    Minimal non-owning view of a contiguous range (std::span is C++20 only).
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+namespace adsvel::log::details {
+    template <class T>
+    class Span {
+       public:
+        constexpr Span() = default;
+        constexpr Span(T* in_data, std::size_t in_size) : data_{in_data}, size_{in_size} {}
+        template <class U, class Alloc, std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>, int> = 0>
+        Span(std::vector<U, Alloc>& in_vector) : data_{in_vector.data()}, size_{in_vector.size()} {}
+        template <class U, class Alloc, std::enable_if_t<std::is_convertible_v<const U (*)[], T (*)[]>, int> = 0>
+        Span(const std::vector<U, Alloc>& in_vector) : data_{in_vector.data()}, size_{in_vector.size()} {}
+
+        constexpr T* data() const { return data_; }
+        constexpr std::size_t size() const { return size_; }
+        constexpr bool empty() const { return size_ == 0; }
+        constexpr T* begin() const { return data_; }
+        constexpr T* end() const { return data_ + size_; }
+        constexpr T& operator[](std::size_t in_index) const { return data_[in_index]; }
+
+       private:
+        T* data_{nullptr};
+        std::size_t size_{0};
+    };
+}  // namespace adsvel::log::details
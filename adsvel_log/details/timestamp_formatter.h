@@ -0,0 +1,96 @@
+/**
+***************************************************************************************************************************************************************
+* @file     timestamp_formatter.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 15:30:12
+* @brief    "%Y.%m.%d %H:%M:%S.mmm" timestamps without localtime_r + strftime per message.
+* @details  The date and time part is formatted once per second and cached, only the fraction is patched in for every message.
+*           The local time is recomputed for every new second, so DST switches (which happen on a second boundary) are picked up
+*           immediately. tzset() is called once per kTzRefreshPeriod so a changed TZ or /etc/localtime is picked up as well.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <time.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+namespace adsvel::log {
+    enum class TimestampPrecision : uint8_t { Milliseconds, Microseconds, Nanoseconds };
+}  // namespace adsvel::log
+
+namespace adsvel::log::details {
+    class TimestampFormatter {
+       public:
+        explicit TimestampFormatter(TimestampPrecision in_precision = TimestampPrecision::Milliseconds) { SetPrecision(in_precision); }
+
+        void SetPrecision(TimestampPrecision in_precision) {
+            precision_ = in_precision;
+            switch (in_precision) {
+                case TimestampPrecision::Milliseconds:
+                    fraction_digits_ = 3;
+                    break;
+                case TimestampPrecision::Microseconds:
+                    fraction_digits_ = 6;
+                    break;
+                case TimestampPrecision::Nanoseconds:
+                    fraction_digits_ = 9;
+                    break;
+            }
+        }
+        TimestampPrecision GetPrecision() const { return precision_; }
+
+        /// Returns "yyyy.mm.dd HH:MM:SS.fff". The view stays valid until the next call.
+        std::string_view Format(std::chrono::system_clock::time_point in_time) {
+            auto ns{std::chrono::duration_cast<std::chrono::nanoseconds>(in_time.time_since_epoch()).count()};
+            int64_t seconds{ns / 1000000000};
+            int64_t fraction_ns{ns % 1000000000};
+            if (fraction_ns < 0) {  // Times before the epoch.
+                fraction_ns += 1000000000;
+                seconds--;
+            }
+            if (seconds != cached_second_) UpdatePrefix_(seconds);
+
+            uint64_t fraction{static_cast<uint64_t>(fraction_ns)};
+            for (int i{fraction_digits_}; i < 9; i++) fraction /= 10;
+            char* digits{buffer_ + prefix_size_ + 1};
+            for (int i{fraction_digits_ - 1}; i >= 0; i--) {
+                digits[i] = static_cast<char>('0' + fraction % 10);
+                fraction /= 10;
+            }
+            return {buffer_, prefix_size_ + 1 + static_cast<size_t>(fraction_digits_)};
+        }
+
+       private:
+        void UpdatePrefix_(int64_t in_seconds) {
+            if (in_seconds - last_tzset_second_ >= kTzRefreshPeriod || in_seconds < last_tzset_second_) {
+#ifdef __GNUC__
+                tzset();
+#else
+                _tzset();
+#endif
+                last_tzset_second_ = in_seconds;
+            }
+            std::time_t time{static_cast<std::time_t>(in_seconds)};
+            std::tm timetm{};
+#ifdef __GNUC__
+            localtime_r(&time, &timetm);
+#else
+            localtime_s(&timetm, &time);
+#endif
+            prefix_size_ = strftime(buffer_, sizeof(buffer_), "%Y.%m.%d %H:%M:%S", &timetm);
+            buffer_[prefix_size_] = '.';
+            cached_second_ = in_seconds;
+        }
+
+        static constexpr int64_t kTzRefreshPeriod{60};  ///< Seconds between tzset() calls.
+        char buffer_[48]{};
+        size_t prefix_size_{0};
+        int64_t cached_second_{std::numeric_limits<int64_t>::min()};
+        int64_t last_tzset_second_{std::numeric_limits<int64_t>::min() / 2};
+        TimestampPrecision precision_{TimestampPrecision::Milliseconds};
+        int fraction_digits_{3};
+    };
+}  // namespace adsvel::log::details
@@ -0,0 +1,202 @@
+/**
+***************************************************************************************************************************************************************
+* @file     binary_sink.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 20:31:44
+* @brief    Compact binary log sink.
+* @details  Writes the format string of every message once per file and then only its id, a varint time delta, the level and the raw
+*           arguments (see details/binary_format.h). Messages that were formatted by the caller are stored as "{}" with the text as the only
+*           argument, so deferred formatting (Logger::SetDeferredFormatting) gives the smallest files. The files are turned back into the
+*           FileSink text layout by the adsvel_log_decode tool.
+*           Every run starts a new file, because an existing file's format table is unknown. Rotation uses the FileSink numbering.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include "../adsvel_log.h"
+#include "../details/binary_format.h"
+#include "../details/crash_writer.h"
+#include "../details/log_file_names.h"
+namespace adsvel::log {
+    class BinarySink : public BaseSink {
+       public:
+        BinarySink(LogLevels in_log_level, const std::string& in_file_name_pattern, size_t in_max_log_file_size_mb, size_t in_amount_of_log_files)
+            : file_names_{in_file_name_pattern}, log_level_{in_log_level}, max_log_file_size_{in_max_log_file_size_mb * 1024 * 1024}, amount_of_log_files_{in_amount_of_log_files}, time_of_last_attempt_open_log_file_(std::chrono::steady_clock::now() - kPeriodBetweenAttemptsOpenLogFile) {
+            if (amount_of_log_files_ > details::LogFileNames::kMaxAmountOfLogFile) throw std::length_error("Exceeded the 'in_amount_of_log_files' during BinarySink initialization.");
+            StartChunk_();
+        }
+        LogLevels GetLevel() override final { return log_level_.load(std::memory_order_relaxed); }
+        void SetLevel(LogLevels in_level) override final { log_level_.store(in_level, std::memory_order_relaxed); }
+        /// Messages lost because the file was unavailable for longer than kMaxSizeOfDelayedWrite bytes of logs.
+        uint64_t GetDroppedMessagesCount() const { return io_counters_.dropped.load(std::memory_order_relaxed); }
+
+        void Log(const LogMessage& in_msg) override final {
+            if (log_level_.load(std::memory_order_relaxed) <= in_msg.level) Encode_(in_msg);
+        }
+        void LogBatch(details::Span<const LogMessage> in_msgs) override final {
+            auto level{log_level_.load(std::memory_order_relaxed)};
+            for (auto& msg : in_msgs) {
+                if (level <= msg.level) Encode_(msg);
+            }
+        }
+        void Flush() override try {
+            if (!file_stream_.is_open()) {
+                if (time_of_last_attempt_open_log_file_ + kPeriodBetweenAttemptsOpenLogFile > std::chrono::steady_clock::now()) return;
+                time_of_last_attempt_open_log_file_ = std::chrono::steady_clock::now();
+                details::BumpCounter(io_counters_.open_attempts);
+                auto files{file_names_.Scan()};
+                auto newest{details::LogFileNames::Newest(files)};
+                current_file_index_ = newest == nullptr ? details::LogFileNames::kFirstNumberOfLogFile : details::LogFileNames::Next(newest->number);
+                if (!OpenFile_()) return;
+            }
+            while (true) {
+                auto& chunk{chunks_.front()};
+                file_stream_.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                if (!file_stream_) {
+                    file_stream_.close();
+                    file_stream_.clear();
+                    if (chunk.compare(0, kBinaryLogMagic.size(), kBinaryLogMagic) != 0) {
+                        // A continuation refers to format ids of the lost file, it can't be moved to a new one.
+                        DropFrontChunk_();
+                        if (chunks_.empty()) StartChunk_();
+                    }
+                    return;  // Complete chunks stay and are written to a fresh file after the reopen.
+                }
+                current_size_of_log_file_ += chunk.size();
+                pending_size_ -= chunk.size();
+                details::BumpCounter(io_counters_.bytes_written, chunk.size());
+                if (chunks_.size() == 1) {
+                    chunk.clear();
+                    chunk_messages_.back() = 0;
+                    break;
+                }
+                chunks_.pop_front();
+                chunk_messages_.pop_front();
+                details::BumpCounter(io_counters_.rotations);
+                current_file_index_ = details::LogFileNames::Next(current_file_index_);
+                if (!OpenFile_()) return;
+            }
+            file_stream_.flush();
+        } catch (...) {  // Don't remove this catch!
+        }
+
+#if defined(__unix__) || defined(__APPLE__)
+        /// Only the chunk of the open file is written, the others would need new files. Binary data never goes to the text crash file.
+        void FlushOnCrash(int in_crash_fd) noexcept override final {
+            (void)in_crash_fd;
+            if (!file_stream_.is_open() || chunks_.empty()) return;
+            int fd{::open(current_file_name_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC)};
+            if (fd < 0) return;
+            details::WriteAll(fd, chunks_.front().data(), chunks_.front().size());
+            ::close(fd);
+        }
+#endif
+
+       private:
+        void Encode_(const LogMessage& in_msg) {
+            std::string_view format{in_msg.format};
+            std::string_view args{in_msg.args};
+            if (format.empty()) {  // Formatted by the caller: "{}" with the text as a string argument.
+                format = kPlainFormat;
+                plain_args_.clear();
+                plain_args_.push_back(static_cast<char>(details::ArgType::String));
+                auto length{static_cast<uint32_t>(in_msg.message.size())};
+                plain_args_.append(reinterpret_cast<const char*>(&length), sizeof(length));
+                plain_args_.append(in_msg.message);
+                args = plain_args_;
+            }
+            auto time_ns{std::chrono::duration_cast<std::chrono::nanoseconds>(in_msg.time.time_since_epoch()).count()};
+            // An estimate is enough to decide on a new file, a format definition is small compared to the file size.
+            size_t record_size{format.size() + args.size() + 32};
+            bool continues_open_file{chunks_.size() == 1 && chunks_.back().compare(0, kBinaryLogMagic.size(), kBinaryLogMagic) != 0};
+            size_t used{chunks_.back().size() + (continues_open_file ? current_size_of_log_file_ : 0)};
+            if (used + record_size > max_log_file_size_ && (chunk_messages_.back() != 0 || continues_open_file)) {
+                chunks_.emplace_back();
+                StartChunk_();
+            }
+            while (pending_size_ + record_size > kMaxSizeOfDelayedWrite && chunks_.size() > 1) DropFrontChunk_();
+            if (pending_size_ + record_size > kMaxSizeOfDelayedWrite) {
+                details::BumpCounter(io_counters_.dropped);
+                return;
+            }
+
+            auto& chunk{chunks_.back()};
+            auto before{chunk.size()};
+            auto it{formats_.find(format)};
+            if (it == formats_.end()) {
+                it = formats_.emplace(format, static_cast<uint32_t>(formats_.size())).first;
+                chunk.push_back(static_cast<char>(details::BinaryRecordType::FormatDef));
+                details::PutVarint(chunk, it->second);
+                details::PutVarint(chunk, format.size());
+                chunk.append(format);
+            }
+            chunk.push_back(static_cast<char>(details::BinaryRecordType::Message));
+            details::PutVarint(chunk, it->second);
+            details::PutVarint(chunk, details::ZigZagEncode(time_ns - previous_time_ns_));
+            chunk.push_back(static_cast<char>(in_msg.level));
+            details::PutVarint(chunk, args.size());
+            chunk.append(args);
+            previous_time_ns_ = time_ns;
+            pending_size_ += chunk.size() - before;
+            chunk_messages_.back()++;
+        }
+
+        void DropFrontChunk_() {
+            pending_size_ -= chunks_.front().size();
+            details::BumpCounter(io_counters_.dropped, chunk_messages_.front());
+            chunks_.pop_front();
+            chunk_messages_.pop_front();
+        }
+        /// Every file starts with the magic and a fresh format table.
+        void StartChunk_() {
+            if (chunks_.empty()) chunks_.emplace_back();
+            chunks_.back().append(kBinaryLogMagic);
+            chunk_messages_.push_back(0);
+            pending_size_ += kBinaryLogMagic.size();
+            formats_.clear();
+            previous_time_ns_ = 0;
+        }
+
+        bool OpenFile_() {
+            file_stream_.close();
+            file_stream_.clear();
+            std::error_code ec;
+            std::filesystem::remove(file_names_.Make(details::LogFileNames::Expired(current_file_index_, amount_of_log_files_)), ec);
+            current_file_name_ = file_names_.Make(current_file_index_);
+            file_stream_.open(current_file_name_, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+            current_size_of_log_file_ = 0;
+            return file_stream_.is_open();
+        }
+
+        static constexpr std::string_view kBinaryLogMagic{details::kBinaryLogMagic};
+        static constexpr std::string_view kPlainFormat{"{}"};
+        static constexpr size_t kMaxSizeOfDelayedWrite{64 * 1024 * 1024};
+        static constexpr std::chrono::duration kPeriodBetweenAttemptsOpenLogFile{std::chrono::seconds(30)};
+        details::LogFileNames file_names_;
+        std::ofstream file_stream_;
+        std::string current_file_name_{};
+        std::deque<std::string> chunks_{};           ///< Bytes not yet written, one chunk per file. The front one goes to the open file.
+        std::deque<uint64_t> chunk_messages_{};      ///< Messages in every chunk, for the drop counter.
+        std::unordered_map<std::string_view, uint32_t> formats_{};  ///< Format ids of the newest chunk. Format strings have static storage.
+        std::string plain_args_{};
+        int64_t previous_time_ns_{0};
+        size_t pending_size_{0};
+        std::atomic<LogLevels> log_level_{LogLevels::Info};  ///< Changed from any thread, read by the one writing the sink.
+        size_t max_log_file_size_{0};
+        size_t amount_of_log_files_{0};
+        size_t current_size_of_log_file_{0};
+        size_t current_file_index_{details::LogFileNames::kFirstNumberOfLogFile};
+        std::chrono::steady_clock::time_point time_of_last_attempt_open_log_file_{};
+    };
+}  // namespace adsvel::log
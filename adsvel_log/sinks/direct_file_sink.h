@@ -0,0 +1,312 @@
+/**
+***************************************************************************************************************************************************************
+* @file     direct_file_sink.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 17:42:19
+* @brief    File sink on top of POSIX file descriptors without iostreams.
+* @details  DirectFileMode::Writev formats lines into preallocated fixed-size blocks and writes all filled blocks with one writev() per flush.
+*           DirectFileMode::Mmap formats lines straight into a memory-mapped segment file preallocated to the maximum file size; the file is
+*           truncated to the written size when it is rotated or the sink is destroyed. If the process dies in this mode the segment keeps its
+*           preallocated size with a zero-filled tail, and the sink continues with the next file on restart.
+*           Files are reserved with fallocate() and rotated with the same "LOG {}.txt" numbering as FileSink. POSIX only.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../adsvel_log.h"
+#include "../details/crash_writer.h"
+#include "../details/log_file_names.h"
+namespace adsvel::log {
+    enum class DirectFileMode : uint8_t { Writev, Mmap };
+
+    class DirectFileSink : public BaseSink {
+       public:
+        DirectFileSink(LogLevels in_log_level, const std::string& in_file_name_pattern, size_t in_max_log_file_size_mb, size_t in_amount_of_log_files, DirectFileMode in_mode = DirectFileMode::Writev)
+            : file_names_{in_file_name_pattern}, log_level_{in_log_level}, mode_{in_mode}, max_log_file_size_{in_max_log_file_size_mb * 1024 * 1024}, amount_of_log_files_{in_amount_of_log_files}, time_of_last_attempt_open_log_file_(std::chrono::steady_clock::now() - kPeriodBetweenAttemptsOpenLogFile) {
+            if (amount_of_log_files_ > details::LogFileNames::kMaxAmountOfLogFile) throw std::length_error("Exceeded the 'in_amount_of_log_files' during DirectFileSink initialization.");
+            if (mode_ == DirectFileMode::Writev) {
+                blocks_.resize(kBlocksCount);
+                for (auto& block : blocks_) block.data = std::make_unique<char[]>(kBlockSize);
+            }
+        }
+        ~DirectFileSink() override {
+            Flush();
+            CloseFile_();
+        }
+        LogLevels GetLevel() override final { return log_level_.load(std::memory_order_relaxed); }
+        void SetLevel(LogLevels in_level) override final { log_level_.store(in_level, std::memory_order_relaxed); }
+        void SetTimestampPrecision(TimestampPrecision in_precision) { timestamp_formatter_.SetPrecision(in_precision); }
+        /// Lines lost because the file couldn't be opened and the write blocks were full.
+        uint64_t GetDroppedLinesCount() const { return io_counters_.dropped.load(std::memory_order_relaxed); }
+
+        void Log(const LogMessage& in_msg) override final {
+            if (log_level_.load(std::memory_order_relaxed) <= in_msg.level) Write_(in_msg);
+        }
+        void LogBatch(details::Span<const LogMessage> in_msgs) override final {
+            auto level{log_level_.load(std::memory_order_relaxed)};
+            for (auto& msg : in_msgs) {
+                if (level <= msg.level) Write_(msg);
+            }
+        }
+        void Flush() override final {
+            if (!EnsureOpen_()) return;
+            if (mode_ == DirectFileMode::Writev) {
+                // Lines buffered while the file was unavailable start a new file rather than overfilling the current one.
+                if (current_size_of_log_file_ != 0 && current_size_of_log_file_ + pending_size_ > max_log_file_size_) RotateLogFile_();
+                if (fd_ >= 0) WriteBlocks_();
+            } else if (map_ != nullptr) {
+                msync(map_, map_offset_, MS_ASYNC);
+            }
+        }
+
+        /// A mapped segment is already in the page cache, it only has to get its real size. Filled blocks go to the file or to in_crash_fd.
+        void FlushOnCrash(int in_crash_fd) noexcept override final {
+            if (mode_ == DirectFileMode::Mmap) {
+                if (fd_ >= 0 && map_ != nullptr) ftruncate(fd_, static_cast<off_t>(map_offset_));
+                return;
+            }
+            for (size_t i{0}; i <= current_block_ && i < blocks_.size(); i++) details::WriteAll(fd_ >= 0 ? fd_ : in_crash_fd, blocks_[i].data.get(), blocks_[i].size);
+        }
+
+       private:
+        struct Block {
+            std::unique_ptr<char[]> data;
+            size_t size{0};
+        };
+
+        void Write_(const LogMessage& in_msg) {
+            auto timestamp{timestamp_formatter_.Format(in_msg.time)};
+            auto level{LogLevelsStr.at(static_cast<uint16_t>(in_msg.level))};
+            std::string_view text{in_msg.message};
+            if (!in_msg.fields.empty()) {
+                text_buffer_.clear();
+                text_buffer_.append(in_msg.message);
+                details::AppendFieldsText(text_buffer_, in_msg.fields);
+                text = std::string_view{text_buffer_.data(), text_buffer_.size()};
+            }
+            if (mode_ == DirectFileMode::Mmap) {
+                if (!EnsureOpen_()) {
+                    details::BumpCounter(io_counters_.dropped);
+                    return;
+                }
+                auto result{fmt::format_to_n(map_ + map_offset_, max_log_file_size_ - map_offset_, kLineFormat, timestamp, level, text)};
+                if (result.size > max_log_file_size_ - map_offset_) {  // Doesn't fit, the line goes to the next file.
+                    RotateLogFile_();
+                    if (map_ == nullptr) {
+                        details::BumpCounter(io_counters_.dropped);
+                        return;
+                    }
+                    result = fmt::format_to_n(map_ + map_offset_, max_log_file_size_ - map_offset_, kLineFormat, timestamp, level, text);
+                    if (result.size > max_log_file_size_ - map_offset_) result.size = max_log_file_size_ - map_offset_;  // A single line bigger than a whole file is cut.
+                }
+                map_offset_ += result.size;
+                details::BumpCounter(io_counters_.bytes_written, result.size);
+                return;
+            }
+
+            line_buffer_.clear();
+            fmt::format_to(std::back_inserter(line_buffer_), kLineFormat, timestamp, level, text);
+            if (EnsureOpen_() && current_size_of_log_file_ + pending_size_ + line_buffer_.size() > max_log_file_size_) {
+                WriteBlocks_();
+                if (fd_ >= 0 && current_size_of_log_file_ + line_buffer_.size() > max_log_file_size_) RotateLogFile_();
+            }
+            if (!AppendToBlocks_({line_buffer_.data(), line_buffer_.size()})) {
+                if (EnsureOpen_()) WriteBlocks_();
+                if (!AppendToBlocks_({line_buffer_.data(), line_buffer_.size()})) details::BumpCounter(io_counters_.dropped);
+            }
+        }
+
+        bool AppendToBlocks_(std::string_view in_line) {
+            size_t free_total{0};
+            for (size_t i{current_block_}; i < blocks_.size(); i++) free_total += kBlockSize - blocks_[i].size;
+            if (free_total < in_line.size()) return false;
+            while (!in_line.empty()) {
+                auto& block{blocks_[current_block_]};
+                auto part{std::min(in_line.size(), kBlockSize - block.size)};
+                std::memcpy(block.data.get() + block.size, in_line.data(), part);
+                block.size += part;
+                pending_size_ += part;
+                in_line.remove_prefix(part);
+                if (block.size == kBlockSize && current_block_ + 1 < blocks_.size()) current_block_++;
+            }
+            return true;
+        }
+
+        void WriteBlocks_() {
+            std::array<iovec, kBlocksCount> iov{};
+            size_t count{0};
+            for (size_t i{0}; i <= current_block_ && i < blocks_.size(); i++) {
+                if (blocks_[i].size == 0) continue;
+                iov[count].iov_base = blocks_[i].data.get();
+                iov[count].iov_len = blocks_[i].size;
+                count++;
+            }
+            iovec* first{iov.data()};
+            size_t written_total{0};
+            while (count > 0) {
+                auto written{writev(fd_, first, static_cast<int>(count))};
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    // Keep the rest, it is written after the file is reopened. What is already in the file must not be written twice.
+                    DropWritten_(written_total);
+                    CloseFile_();
+                    return;
+                }
+                written_total += static_cast<size_t>(written);
+                current_size_of_log_file_ += static_cast<size_t>(written);
+                details::BumpCounter(io_counters_.bytes_written, static_cast<uint64_t>(written));
+                while (count > 0 && static_cast<size_t>(written) >= first->iov_len) {
+                    written -= static_cast<ssize_t>(first->iov_len);
+                    first++;
+                    count--;
+                }
+                if (count > 0) {
+                    first->iov_base = static_cast<char*>(first->iov_base) + written;
+                    first->iov_len -= static_cast<size_t>(written);
+                }
+            }
+            for (auto& block : blocks_) block.size = 0;
+            current_block_ = 0;
+            pending_size_ = 0;
+        }
+
+        /// Moves the data after the first in_size bytes to the start of the blocks.
+        void DropWritten_(size_t in_size) {
+            if (in_size == 0) return;
+            std::array<size_t, kBlocksCount> sizes{};
+            size_t target{0};
+            size_t skip{in_size};
+            for (size_t i{0}; i <= current_block_ && i < blocks_.size(); i++) {
+                const auto& source{blocks_[i]};
+                auto offset{std::min(skip, source.size)};
+                skip -= offset;
+                while (offset < source.size) {  // The target never overtakes the source, so a block is only overwritten after it is read.
+                    if (sizes[target] == kBlockSize) target++;
+                    auto part{std::min(source.size - offset, kBlockSize - sizes[target])};
+                    std::memmove(blocks_[target].data.get() + sizes[target], source.data.get() + offset, part);
+                    sizes[target] += part;
+                    offset += part;
+                }
+            }
+            for (size_t i{0}; i < blocks_.size(); i++) blocks_[i].size = sizes[i];
+            current_block_ = (sizes[target] == kBlockSize && target + 1 < blocks_.size()) ? target + 1 : target;
+            pending_size_ -= std::min(in_size, pending_size_);
+        }
+
+        bool EnsureOpen_() {
+            if (fd_ >= 0) return true;
+            if (time_of_last_attempt_open_log_file_ + kPeriodBetweenAttemptsOpenLogFile > std::chrono::steady_clock::now()) return false;
+            time_of_last_attempt_open_log_file_ = std::chrono::steady_clock::now();
+            details::BumpCounter(io_counters_.open_attempts);
+            auto files{file_names_.Scan()};
+            auto newest{details::LogFileNames::Newest(files)};
+            if (newest == nullptr) {
+                current_file_index_ = details::LogFileNames::kFirstNumberOfLogFile;
+            } else if (newest->size < max_log_file_size_) {
+                current_file_index_ = newest->number;
+            } else {
+                current_file_index_ = details::LogFileNames::Next(newest->number);
+                RemoveIrrelevantLogsFile_(current_file_index_);
+            }
+            if (!OpenFile_(current_file_index_, false)) return false;
+            std::string open_line{std::string{kOpenFileMessage} + "\n"};
+            if (mode_ == DirectFileMode::Mmap) {
+                if (map_offset_ + open_line.size() <= max_log_file_size_) {
+                    std::memcpy(map_ + map_offset_, open_line.data(), open_line.size());
+                    map_offset_ += open_line.size();
+                }
+            } else if (write(fd_, open_line.data(), open_line.size()) > 0) {
+                current_size_of_log_file_ += open_line.size();
+            }
+            return true;
+        }
+
+        bool OpenFile_(size_t in_number, bool in_truncate) {
+            auto name{file_names_.Make(in_number)};
+            fd_ = open(name.c_str(), O_CREAT | O_CLOEXEC | (in_truncate ? O_TRUNC : 0) | (mode_ == DirectFileMode::Writev ? O_WRONLY | O_APPEND : O_RDWR), 0644);  // A shared writable mapping needs O_RDWR.
+            if (fd_ < 0) return false;
+            auto size{lseek(fd_, 0, SEEK_END)};
+            current_size_of_log_file_ = size > 0 ? static_cast<size_t>(size) : 0;
+            if (mode_ == DirectFileMode::Writev) {
+#ifdef __linux__
+                fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(max_log_file_size_));  // Only a hint, errors (e.g. unsupported filesystem) are ignored.
+#endif
+                return true;
+            }
+            if (ftruncate(fd_, static_cast<off_t>(max_log_file_size_)) != 0) {
+                CloseFile_();
+                return false;
+            }
+#ifdef __linux__
+            fallocate(fd_, 0, 0, static_cast<off_t>(max_log_file_size_));
+#endif
+            void* map{mmap(nullptr, max_log_file_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0)};
+            if (map == MAP_FAILED) {
+                ftruncate(fd_, static_cast<off_t>(current_size_of_log_file_));
+                CloseFile_();
+                return false;
+            }
+            map_ = static_cast<char*>(map);
+            map_offset_ = current_size_of_log_file_;
+            return true;
+        }
+
+        void CloseFile_() {
+            if (fd_ < 0) return;
+            if (map_ != nullptr) {
+                munmap(map_, max_log_file_size_);
+                map_ = nullptr;
+                ftruncate(fd_, static_cast<off_t>(map_offset_));
+                map_offset_ = 0;
+            }
+            close(fd_);
+            fd_ = -1;
+        }
+
+        void RotateLogFile_() {
+            CloseFile_();
+            details::BumpCounter(io_counters_.rotations);
+            current_file_index_ = details::LogFileNames::Next(current_file_index_);
+            RemoveIrrelevantLogsFile_(current_file_index_);
+            OpenFile_(current_file_index_, true);
+            current_size_of_log_file_ = 0;
+        }
+
+        void RemoveIrrelevantLogsFile_(size_t in_current_file_num) { unlink(file_names_.Make(details::LogFileNames::Expired(in_current_file_num, amount_of_log_files_)).c_str()); }
+
+        static constexpr size_t kBlockSize{64 * 1024};
+        static constexpr size_t kBlocksCount{16};
+        static constexpr std::chrono::duration kPeriodBetweenAttemptsOpenLogFile{std::chrono::seconds(30)};
+        static constexpr std::string_view kOpenFileMessage{"=========================== START A NEW RECORD =========================="};
+        static constexpr std::string_view kLineFormat{"[{0}][{1:6}] {2}\n"};
+        details::LogFileNames file_names_;
+        details::TimestampFormatter timestamp_formatter_{};
+        fmt::memory_buffer line_buffer_;
+        fmt::memory_buffer text_buffer_;  ///< Message text with its structured fields.
+        std::vector<Block> blocks_;  ///< Write blocks of the Writev mode, allocated once.
+        size_t current_block_{0};
+        size_t pending_size_{0};  ///< Bytes in blocks_ that aren't written yet.
+        int fd_{-1};
+        char* map_{nullptr};   ///< Mapped segment of the Mmap mode.
+        size_t map_offset_{0};  ///< Write position in map_, becomes the file size when the segment is closed.
+        std::atomic<LogLevels> log_level_{LogLevels::Info};  ///< Changed from any thread, read by the one writing the sink.
+        DirectFileMode mode_{DirectFileMode::Writev};
+        size_t max_log_file_size_{0};
+        size_t amount_of_log_files_{0};
+        size_t current_size_of_log_file_{0};
+        size_t current_file_index_{details::LogFileNames::kFirstNumberOfLogFile};
+        std::chrono::steady_clock::time_point time_of_last_attempt_open_log_file_{};
+    };
+}  // namespace adsvel::log
@@ -2,238 +2,242 @@
 ***************************************************************************************************************************************************************
 * @file     file_sink.h
 * @author   Kuznetsov A.(RivandBlack).
-* @version  v 0.0.4
-* @date     01.07.2019 12:39:04
+* @version  v 0.0.5
+* @date     17.10.2026 18:20:37
 * @brief    file_sink
+* @details  Lines are accumulated in a fixed-capacity ring of segments, one segment per log file. The first segment is appended to the
+*           currently open file, every following one starts a new file. While the file can't be opened the ring keeps at most
+*           kMaxSizeOfDelayedWriteToLoggingFile bytes; when it is exceeded the oldest segment is dropped.
+*           With FileCompression::Zstd every closed file is compressed in the background by details::SegmentCompressor and the retention
+*           counts bytes instead of files: all files together may take in_amount_of_log_files * in_max_log_file_size_mb on disk.
 ***************************************************************************************************************************************************************
 */
 #pragma once
-#include <time.h>
-#include <bitset>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
-#include <iomanip>
-#include <map>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 #include "../adsvel_log.h"
+#include "../details/crash_writer.h"
+#include "../details/log_file_names.h"
+#include "../details/segment_compressor.h"
 namespace adsvel::log {
-    using std::map;
     using std::string;
 
     class FileSink : public BaseSink {
        public:
-        FileSink(LogLevels in_log_level, const string in_file_name_pattern, size_t in_max_log_file_size_mb, size_t in_amount_of_log_files)
-            : file_name_pattern_{in_file_name_pattern}, log_level_{in_log_level}, max_log_file_size_{in_max_log_file_size_mb * 1024 * 1024}, amount_of_log_files_{in_amount_of_log_files}, time_of_last_attempt_open_log_file_(std::chrono::steady_clock::now() - kPeriodBetweenAttemptsOpenLogFile) {
+        FileSink(LogLevels in_log_level, const string in_file_name_pattern, size_t in_max_log_file_size_mb, size_t in_amount_of_log_files, FileCompression in_compression = FileCompression::None)
+            : file_names_{in_file_name_pattern}, log_level_{in_log_level}, max_log_file_size_{in_max_log_file_size_mb * 1024 * 1024}, amount_of_log_files_{in_amount_of_log_files}, time_of_last_attempt_open_log_file_(std::chrono::steady_clock::now() - kPeriodBetweenAttemptsOpenLogFile) {
             if (amount_of_log_files_ > kMaxAmountOfLogFile) {
                 amount_of_log_files_ = kMaxAmountOfLogFile;
                 throw std::length_error("Exceeded the 'in_amount_of_log_files' during FileSink initialization.");
             }
+            if (in_compression == FileCompression::Zstd) {
+                if (!details::kZstdAvailable) throw std::invalid_argument("FileSink compression requested, but adsvel_log was built without zstd.");
+                compressor_ = std::make_unique<details::SegmentCompressor>(file_names_, static_cast<uintmax_t>(max_log_file_size_) * amount_of_log_files_);
+            }
+            // More segments than files to keep would be deleted by the rotation anyway.
+            size_t capacity{max_log_file_size_ != 0 ? kMaxSizeOfDelayedWriteToLoggingFile / max_log_file_size_ : 1};
+            segments_.resize(std::clamp<size_t>(capacity, 2, std::max<size_t>(amount_of_log_files_, 1) + 1));
         }
-        LogLevels GetLevel() override final { return log_level_; }
-        void SetLevel(LogLevels in_level) override final { log_level_ = in_level; }
+        LogLevels GetLevel() override final { return log_level_.load(std::memory_order_relaxed); }
+        void SetLevel(LogLevels in_level) override final { log_level_.store(in_level, std::memory_order_relaxed); }
+        void SetTimestampPrecision(TimestampPrecision in_precision) { timestamp_formatter_.SetPrecision(in_precision); }
+        /// Lines lost because the log file was unavailable for longer than the delayed write buffer could hold.
+        uint64_t GetDroppedLinesCount() const { return io_counters_.dropped.load(std::memory_order_relaxed); }
 
         void Log(const LogMessage& in_msg) override final {
-            if (log_level_ <= in_msg.level) {
-                std::time_t time = std::chrono::system_clock::to_time_t(in_msg.time);
-                std::tm timetm{};
-#ifdef __GNUC__
-                localtime_r(&time, &timetm);
-#else
-                localtime_s(&timetm, &time);
-#endif
-                char date_time_format[] = "%Y.%m.%d %H:%M:%S";
-                char time_str[] = "yyyy.mm.dd HH:MM:SS.mmm---";
-                strftime(time_str, strlen(time_str), date_time_format, &timetm);
-                string line{fmt::format("[{0}.{1:03}][{2:6}] {3}\n", time_str, std::chrono::duration_cast<std::chrono::milliseconds>(in_msg.time.time_since_epoch()).count() % 1000, LogLevelsStr.at(static_cast<uint16_t>(in_msg.level)), in_msg.message)};
-
-                if (current_accumulated_logs_set_index_ == current_file_index_) {
-                    if (current_size_of_log_file_ + line.size() + accumulated_logs_[current_accumulated_logs_set_index_].size() <= max_log_file_size_) {
-                        accumulated_logs_[current_accumulated_logs_set_index_].append(line);
-                        current_size_of_log_file_ += line.size();
-                    } else {
-                        full_flags_of_accumulated_logs_[current_accumulated_logs_set_index_] = true;
-                        current_accumulated_logs_set_index_++;
-                        accumulated_logs_[current_accumulated_logs_set_index_].append(line);
-                    }
-                } else {
-                    if (accumulated_logs_[current_accumulated_logs_set_index_].size() + line.size() <= max_log_file_size_) {
-                        accumulated_logs_[current_accumulated_logs_set_index_].append(line);
-                    } else {
-                        full_flags_of_accumulated_logs_[current_accumulated_logs_set_index_] = true;
-                        current_accumulated_logs_set_index_++;
-                        accumulated_logs_[current_accumulated_logs_set_index_].append(line);
-                    }
-                }
+            if (log_level_.load(std::memory_order_relaxed) <= in_msg.level) {
+                line_buffer_.clear();
+                FormatLine_(in_msg);
+                AppendLine_({line_buffer_.data(), line_buffer_.size()});
+            }
+        }
+        void LogBatch(details::Span<const LogMessage> in_msgs) override final {
+            auto level{log_level_.load(std::memory_order_relaxed)};
+            for (auto& msg : in_msgs) {
+                if (level > msg.level) continue;
+                line_buffer_.clear();
+                FormatLine_(msg);
+                AppendLine_({line_buffer_.data(), line_buffer_.size()});
             }
         }
         void Flush() override try {
-            for (size_t i{current_file_index_}; i <= current_accumulated_logs_set_index_; i++) {
-                if (logs_file_stream_.is_open()) {
-                    logs_file_stream_ << accumulated_logs_[i] << std::flush;
-                    accumulated_logs_[i].clear();
-                    if (full_flags_of_accumulated_logs_[i]) {
-                        full_flags_of_accumulated_logs_[i] = false;
-                        RotateLogFile_();
-                    } else {
-                        return;
-                    }
-
-                } else {
-                    if (time_of_last_attempt_open_log_file_ + kPeriodBetweenAttemptsOpenLogFile <= std::chrono::steady_clock::now()) {
-                        time_of_last_attempt_open_log_file_ = std::chrono::steady_clock::now();
-                        OpenRelevantLogFile_();
-                        i = current_file_index_;
-                        if (!logs_file_stream_.is_open()) {
-                            return;
-                        } else {
-                            // Нужно еще раз перепроверить размеры, если размеры не сходятся, то записываем все логи в следующий файл.
-                            // Из-за этого у нас один из файлов будет заполнен не до конца, но это лучше, чем если бы он был большего размера, чем рассчитывал пользователь.
-                            if (current_size_of_log_file_ + accumulated_logs_[i].size() > max_log_file_size_) {
-                                ShiftAccumulatedLogsMapToRight_(1);
-                                RotateLogFile_();
-                            }
-                            // Если файл с логами открыть наконец удалось, то скидываем туда всё что накопили.
-                            logs_file_stream_ << open_file_message_ << std::flush << std::endl;
-                            logs_file_stream_ << accumulated_logs_[i] << std::flush;
-                            accumulated_logs_[i].clear();
-                            if (full_flags_of_accumulated_logs_[i]) {
-                                full_flags_of_accumulated_logs_[i] = false;
-                                RotateLogFile_();
-                            } else {
-                                return;
-                            }
-                        }
-                    }
+            if (!logs_file_stream_.is_open()) {
+                if (time_of_last_attempt_open_log_file_ + kPeriodBetweenAttemptsOpenLogFile > std::chrono::steady_clock::now()) return;
+                time_of_last_attempt_open_log_file_ = std::chrono::steady_clock::now();
+                details::BumpCounter(io_counters_.open_attempts);
+                OpenRelevantLogFile_();
+                if (!logs_file_stream_.is_open()) return;
+                // Нужно еще раз перепроверить размеры, если размеры не сходятся, то записываем все логи в следующий файл.
+                // Из-за этого у нас один из файлов будет заполнен не до конца, но это лучше, чем если бы он был большего размера, чем рассчитывал пользователь.
+                auto& head{segments_[head_]};
+                if (current_size_of_log_file_ != 0 && current_size_of_log_file_ + head.data.size() > max_log_file_size_) head.starts_new_file = true;
+                if (!open_file_message_.empty()) logs_file_stream_ << open_file_message_ << std::endl;
+            }
+            // Если файл с логами открыт, то скидываем туда всё что накопили.
+            while (true) {
+                auto& segment{segments_[head_]};
+                if (segment.starts_new_file) {
+                    RotateLogFile_();
+                    segment.starts_new_file = false;
                 }
+                logs_file_stream_.write(segment.data.data(), static_cast<std::streamsize>(segment.data.size()));
+                if (!logs_file_stream_) {  // The data stays in the ring and is written after the file is reopened.
+                    logs_file_stream_.close();
+                    logs_file_stream_.clear();
+                    return;
+                }
+                current_size_of_log_file_ += segment.data.size();
+                pending_size_ -= segment.data.size();
+                details::BumpCounter(io_counters_.bytes_written, segment.data.size());
+                segment.data.clear();
+                segment.lines = 0;
+                if (count_ == 1) break;
+                head_ = (head_ + 1) % segments_.size();
+                count_--;
             }
-        }              // namespace adsvel::log
-        catch (...) {  // Don't remove this catch!
+            logs_file_stream_.flush();
+        } catch (...) {  // Don't remove this catch!
         }
+#if defined(__unix__) || defined(__APPLE__)
+        /// All segments go to the open file, or to in_crash_fd if there is none.
+        void FlushOnCrash(int in_crash_fd) noexcept override final {
+            int fd{logs_file_stream_.is_open() ? ::open(logs_file_full_name_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC) : -1};
+            for (size_t i{0}; i < count_; i++) {
+                auto& segment{segments_[(head_ + i) % segments_.size()]};
+                details::WriteAll(fd >= 0 ? fd : in_crash_fd, segment.data.data(), segment.data.size());
+            }
+            if (fd >= 0) ::close(fd);
+        }
+#endif
 
-       private:
-        string MakeLogsFileFullName_(std::size_t in_file_num) { return fmt::format(file_name_pattern_, in_file_num); }
-        void RemoveIrrelevantLogsFile(size_t in_current_file_num) {
-            size_t delete_file_num = in_current_file_num - amount_of_log_files_;
-            if (delete_file_num < 1) delete_file_num += kMaxNumberOfLogFile;
-            std::filesystem::path logs_file{MakeLogsFileFullName_(delete_file_num)};
-            if (exists(logs_file)) remove(logs_file);
+       protected:
+        /// Appends the line of in_msg, with its '\n', to line_buffer_. Overridden by sinks that write another layout to the same rotating files.
+        virtual void FormatLine_(const LogMessage& in_msg) {
+            fmt::format_to(std::back_inserter(line_buffer_), "[{0}][{1:6}] {2}", timestamp_formatter_.Format(in_msg.time), LogLevelsStr.at(static_cast<uint16_t>(in_msg.level)), in_msg.message);
+            details::AppendFieldsText(line_buffer_, in_msg.fields);
+            line_buffer_.push_back('\n');
         }
 
-        void OpenRelevantLogFile_() {
-            uint16_t counter{kMaxNumberOfLogFile};
-            size_t tmp_file_index{current_file_index_};  // Need which would then calculate the index offset.
-            logs_file_full_name_ = MakeLogsFileFullName_(counter);
-            if (exists(logs_file_full_name_)) {
-                counter = kMaxAmountOfLogFile;  // Если есть 9999тый файл логов, то это означает что был пройден круг с 1 до 9999 и нам надо искать файл с середины.
-                logs_file_full_name_ = MakeLogsFileFullName_(counter);
+        std::string open_file_message_{"=========================== START A NEW RECORD =========================="};  ///< Written when a file is opened, unless empty.
+        details::TimestampFormatter timestamp_formatter_{};
+        fmt::memory_buffer line_buffer_;  ///< Reused for formatting every line, so Log() doesn't allocate a string per message.
+
+       private:
+        struct Segment {
+            string data{};
+            size_t lines{0};
+            bool starts_new_file{false};  ///< The segment goes to the next log file, not to the current one.
+        };
+
+        void AppendLine_(std::string_view line) {
+            size_t tail{(head_ + count_ - 1) % segments_.size()};
+            auto& last{segments_[tail]};
+            size_t used{last.data.size()};
+            if (tail == head_ && !last.starts_new_file) used += current_size_of_log_file_;  // The head segment is appended to the open file.
+            if (used + line.size() > max_log_file_size_ && !last.data.empty()) {
+                if (count_ == segments_.size()) DropOldestSegment_();
+                tail = (head_ + count_) % segments_.size();
+                segments_[tail].starts_new_file = true;
+                count_++;
             }
-            // Ищем существующий файл с логами начиная с номера 9999 (или 5000) и спускаемся вниз пока не найдёт его(или не достигнем counter = 0 что будет означать что актуальных файлов нет).
-            while (true) {
-                if (exists(logs_file_full_name_)) {  // Нашли подходящий файл.
-                    current_size_of_log_file_ = file_size(logs_file_full_name_);
-                    if (current_size_of_log_file_ < max_log_file_size_) {  // Был заполнен этот файл до конца или там еще осталось место.
-                        logs_file_stream_.open(logs_file_full_name_.string(), std::ofstream::out | std::ofstream::app);
-                        current_file_index_ = counter;
-                        break;
-                    } else {
-                        counter++;
-                        if (counter >= kMaxNumberOfLogFile) counter = kFirstNumberOfLogFile;
-                        logs_file_full_name_ = MakeLogsFileFullName_(counter);
-                        logs_file_stream_.open(logs_file_full_name_.string(), std::ofstream::out | std::ofstream::app);
-                        current_size_of_log_file_ = 0;
-                        current_file_index_ = counter;
-                        break;
-                    }
-                }
-                counter--;
-                logs_file_full_name_ = MakeLogsFileFullName_(counter);
-                if (counter == 0) {
-                    logs_file_full_name_ = MakeLogsFileFullName_(kFirstNumberOfLogFile);
-                    logs_file_stream_.open(logs_file_full_name_.string(), std::ofstream::out | std::ofstream::app);
-                    current_size_of_log_file_ = 0;
-                    current_file_index_ = kFirstNumberOfLogFile;
-                    break;
-                }
+            while (pending_size_ + line.size() > kMaxSizeOfDelayedWriteToLoggingFile && count_ > 1) DropOldestSegment_();
+            if (pending_size_ + line.size() > kMaxSizeOfDelayedWriteToLoggingFile) {
+                details::BumpCounter(io_counters_.dropped);
+                return;
             }
-            // Need to adjust the current_file_index_ and the accumulated_logs_
-            if (tmp_file_index < current_file_index_) {
-                auto offset = current_file_index_ - tmp_file_index;
-                ShiftAccumulatedLogsMapToRight_(offset);
-                current_accumulated_logs_set_index_ += offset;
-                if (current_accumulated_logs_set_index_ > kMaxNumberOfLogFile) current_accumulated_logs_set_index_ -= kMaxNumberOfLogFile;
+            segments_[tail].data.append(line);
+            segments_[tail].lines++;
+            pending_size_ += line.size();
+        }
+        void DropOldestSegment_() {
+            auto& head{segments_[head_]};
+            details::BumpCounter(io_counters_.dropped, head.lines);
+            pending_size_ -= head.data.size();
+            string().swap(head.data);  // Give the memory back, a long outage shouldn't pin the peak.
+            head.lines = 0;
+            head.starts_new_file = false;
+            head_ = (head_ + 1) % segments_.size();
+            count_--;
+            segments_[head_].starts_new_file = true;  // The current file was never completed, the next segment still starts a new one.
+        }
+
+        void OpenRelevantLogFile_() {
+            // Один проход по директории вместо поиска exists() по всем 9999 именам.
+            auto files{file_names_.Scan()};
+            auto newest{details::LogFileNames::Newest(files)};
+            if (newest == nullptr) {
+                current_file_index_ = kFirstNumberOfLogFile;
+                current_size_of_log_file_ = 0;
+            } else if (newest->size < max_log_file_size_ && !newest->compressed) {  // Был заполнен этот файл до конца или там еще осталось место.
+                current_file_index_ = newest->number;
+                current_size_of_log_file_ = newest->size;
+            } else {
+                current_file_index_ = details::LogFileNames::Next(newest->number);
+                RemoveIrrelevantLogsFile(current_file_index_);
+                current_size_of_log_file_ = 0;
             }
-            if (tmp_file_index > current_file_index_) {
-                auto offset = tmp_file_index - current_file_index_;
-                ShiftAccumulatedLogsMapToLeft_(offset);
-                if (current_accumulated_logs_set_index_ > offset) {
-                    current_accumulated_logs_set_index_ -= offset;
-                } else {
-                    current_accumulated_logs_set_index_ = current_accumulated_logs_set_index_ + kMaxNumberOfLogFile - offset;
+            logs_file_full_name_ = file_names_.Make(current_file_index_);
+            logs_file_stream_.open(logs_file_full_name_.string(), std::ofstream::out | std::ofstream::app);
+            if (compressor_ != nullptr) {  // Files left uncompressed by the previous run.
+                std::vector<size_t> closed;
+                for (auto& file : files) {
+                    if (!file.compressed && file.number != current_file_index_) closed.push_back(file.number);
                 }
+                compressor_->Submit(closed, current_file_index_);
             }
         }
+        void RemoveIrrelevantLogsFile(size_t in_current_file_num) {
+            if (compressor_ != nullptr) return;  // The compressor keeps files by their size on disk.
+            std::filesystem::path logs_file{file_names_.Make(details::LogFileNames::Expired(in_current_file_num, amount_of_log_files_))};
+            std::error_code ec;
+            remove(logs_file, ec);
+        }
         void RotateLogFile_() {
             logs_file_stream_.flush();
             logs_file_stream_.close();
-            current_file_index_++;
-            if (current_file_index_ > kMaxNumberOfLogFile) current_file_index_ = kFirstNumberOfLogFile;
+            details::BumpCounter(io_counters_.rotations);
+            auto closed_file_index{current_file_index_};
+            current_file_index_ = details::LogFileNames::Next(current_file_index_);
             RemoveIrrelevantLogsFile(current_file_index_);
-            logs_file_full_name_ = MakeLogsFileFullName_(current_file_index_);
-            std::filesystem::path logs_file{logs_file_full_name_};
-            if (exists(logs_file)) remove(logs_file);
+            logs_file_full_name_ = file_names_.Make(current_file_index_);
+            std::error_code ec;
+            remove(logs_file_full_name_, ec);
+            if (compressor_ != nullptr) {
+                std::filesystem::remove(logs_file_full_name_.string() + std::string(details::LogFileNames::kCompressedSuffix), ec);
+                compressor_->Submit({closed_file_index}, current_file_index_);
+            }
             logs_file_stream_.open(logs_file_full_name_.string(), std::ofstream::out | std::ofstream::app);
             current_size_of_log_file_ = 0;
         }
 
-        void ShiftAccumulatedLogsMapToRight_(size_t offset) {
-            auto begin{accumulated_logs_.begin()->first};
-            for (auto end{accumulated_logs_.end()->first}; begin <= end; end--) {
-                auto extracted_node = accumulated_logs_.extract(end);
-                auto new_key = extracted_node.key() + offset;
-                if (new_key > kMaxNumberOfLogFile) new_key -= kMaxNumberOfLogFile;
-                full_flags_of_accumulated_logs_[new_key] = full_flags_of_accumulated_logs_[extracted_node.key()];
-                full_flags_of_accumulated_logs_[extracted_node.key()] = false;
-                extracted_node.key() = new_key;
-                accumulated_logs_.insert(move(extracted_node));
-            }
-        }
-        void ShiftAccumulatedLogsMapToLeft_(size_t offset) {
-            auto end{accumulated_logs_.end()->first};
-            for (auto begin{accumulated_logs_.begin()->first}; begin <= end; begin++) {
-                auto extracted_node = accumulated_logs_.extract(begin);
-                size_t new_key{};
-                if (extracted_node.key() > offset) {
-                    new_key = extracted_node.key() - offset;
-                } else {
-                    new_key = (extracted_node.key() + kMaxNumberOfLogFile) - offset;
-                }
-                full_flags_of_accumulated_logs_[new_key] = full_flags_of_accumulated_logs_[extracted_node.key()];
-                full_flags_of_accumulated_logs_[extracted_node.key()] = false;
-                extracted_node.key() = new_key;
-                accumulated_logs_.insert(move(extracted_node));
-            }
-        }
-
-        static constexpr uint16_t kMaxNumberOfLogFile{9999};
-        static constexpr uint16_t kMaxAmountOfLogFile{5000};
-        static constexpr uint16_t kFirstNumberOfLogFile{1};
+        static constexpr uint16_t kMaxAmountOfLogFile{details::LogFileNames::kMaxAmountOfLogFile};
+        static constexpr uint16_t kFirstNumberOfLogFile{details::LogFileNames::kFirstNumberOfLogFile};
         static constexpr std::chrono::duration kPeriodBetweenAttemptsOpenLogFile{std::chrono::seconds(30)};
         static constexpr uint32_t kMaxSizeOfDelayedWriteToLoggingFile{100 * 1024 * 1024};
-        const std::string open_file_message_{"=========================== START A NEW RECORD =========================="};
-        const std::string file_name_pattern_;
+        details::LogFileNames file_names_;
         std::ofstream logs_file_stream_;
-        std::string message_pattern_{""};
+        std::unique_ptr<details::SegmentCompressor> compressor_{};  ///< Only with FileCompression::Zstd.
         size_t current_file_index_{kFirstNumberOfLogFile};
         std::filesystem::path logs_file_full_name_{""};                               ///< Полный путь к файлу с логами, с которым в текущий момент работает логер.
         std::chrono::steady_clock::time_point time_of_last_attempt_open_log_file_{};  ///< Время последней попытки открыть файл с логами.
-        std::map<size_t, string> accumulated_logs_{};                                 ///< <log_file_index, log_content>
-        std::bitset<kMaxNumberOfLogFile> full_flags_of_accumulated_logs_{};
-        size_t current_accumulated_logs_set_index_{kFirstNumberOfLogFile};
+        std::vector<Segment> segments_{};                                             ///< Ring of not yet written segments, segments_[head_] goes to the current file.
+        size_t head_{0};
+        size_t count_{1};         ///< Segments in use, there is always at least one.
+        size_t pending_size_{0};  ///< Bytes in all segments, bounded by kMaxSizeOfDelayedWriteToLoggingFile.
         size_t max_log_file_size_{0};
         size_t amount_of_log_files_{0};
         size_t current_size_of_log_file_{0};
-        LogLevels log_level_{LogLevels::Info};
+        std::atomic<LogLevels> log_level_{LogLevels::Info};  ///< Changed from any thread, read by the one writing the sink.
     };  // namespace adsvel::log
 
 }  // namespace adsvel::log
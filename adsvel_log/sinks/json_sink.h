@@ -0,0 +1,126 @@
+/**
+***************************************************************************************************************************************************************
+* @file     json_sink.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     18.10.2026 01:58:44
+* @brief    JSON lines sink.
+* @details  One JSON object per line:
+*           {"time":"2026-10-18T01:58:44.123456Z","level":"Info","thread":4242,"file":"a.cpp","line":12,"function":"Run","message":"...","key":value}
+*           The time is UTC with microseconds, the source location is present when the message has one, the structured fields follow as members
+*           of their own (JSON types for numbers and booleans, strings otherwise), a key that names one of the fixed members is written as
+*           "fields.<key>" so every object keeps unique names. Lines are written straight into the line buffer with a
+*           hand-rolled escaper (details::AppendQuoted()), no DOM is built. The files, rotation, delayed write and compression are those of FileSink.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <array>
+#include <cmath>
+#include <ctime>
+#include <string_view>
+#include "file_sink.h"
+namespace adsvel::log {
+    class JsonSink : public FileSink {
+       public:
+        JsonSink(LogLevels in_log_level, const std::string& in_file_name_pattern, size_t in_max_log_file_size_mb, size_t in_amount_of_log_files, FileCompression in_compression = FileCompression::None)
+            : FileSink(in_log_level, in_file_name_pattern, in_max_log_file_size_mb, in_amount_of_log_files, in_compression) {
+            open_file_message_.clear();  // Every line must be a JSON object.
+        }
+
+       protected:
+        void FormatLine_(const LogMessage& in_msg) override {
+            Append_("{\"time\":\"");
+            AppendTime_(in_msg.time);
+            Append_("\",\"level\":\"");
+            Append_(kLevelNames.at(static_cast<size_t>(in_msg.level)));
+            Append_("\",\"thread\":");
+            fmt::format_to(std::back_inserter(line_buffer_), "{}", in_msg.thread_id);
+            if (in_msg.location.file != nullptr) {
+                Append_(",\"file\":");
+                AppendString_(in_msg.location.file);
+                fmt::format_to(std::back_inserter(line_buffer_), ",\"line\":{}", in_msg.location.line);
+                if (in_msg.location.function != nullptr) {
+                    Append_(",\"function\":");
+                    AppendString_(in_msg.location.function);
+                }
+            }
+            Append_(",\"message\":");
+            AppendString_(in_msg.message);
+            if (!in_msg.fields.empty()) AppendFields_(in_msg.fields);
+            Append_("}\n");
+        }
+
+       private:
+        void Append_(std::string_view in_text) { line_buffer_.append(in_text.data(), in_text.data() + in_text.size()); }
+
+        void AppendString_(std::string_view in_text) { details::AppendQuoted(line_buffer_, in_text); }
+
+        void AppendFields_(std::string_view in_fields) {
+            try {
+                details::ForEachField(in_fields, [&](std::string_view in_key, auto in_value) {
+                    using T = decltype(in_value);
+                    line_buffer_.push_back(',');
+                    if (IsReservedKey_(in_key)) {
+                        AppendString_(fmt::format("fields.{}", in_key));
+                    } else {
+                        AppendString_(in_key);
+                    }
+                    line_buffer_.push_back(':');
+                    if constexpr (std::is_same_v<T, std::string_view>) {
+                        AppendString_(in_value);
+                    } else if constexpr (std::is_same_v<T, char>) {
+                        AppendString_({&in_value, 1});
+                    } else if constexpr (std::is_same_v<T, bool>) {
+                        Append_(in_value ? "true" : "false");
+                    } else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+                        if (std::isfinite(in_value)) {
+                            fmt::format_to(std::back_inserter(line_buffer_), "{}", in_value);
+                        } else {  // JSON has no NaN or infinity.
+                            AppendString_(fmt::format("{}", in_value));
+                        }
+                    } else if constexpr (std::is_same_v<T, const void*>) {
+                        fmt::format_to(std::back_inserter(line_buffer_), "\"{}\"", in_value);
+                    } else {
+                        fmt::format_to(std::back_inserter(line_buffer_), "{}", in_value);
+                    }
+                });
+            } catch (const std::exception& e) {
+                Append_(",\"fields_error\":");
+                AppendString_(e.what());
+            }
+        }
+
+        static bool IsReservedKey_(std::string_view in_key) {
+            for (auto key : kReservedKeys) {
+                if (key == in_key) return true;
+            }
+            return false;
+        }
+
+        /// "yyyy-mm-ddTHH:MM:SS.uuuuuuZ", the part up to the seconds is cached, consecutive messages mostly share it.
+        void AppendTime_(std::chrono::system_clock::time_point in_time) {
+            auto us{std::chrono::duration_cast<std::chrono::microseconds>(in_time.time_since_epoch()).count()};
+            auto seconds{us / 1000000};
+            auto fraction{us % 1000000};
+            if (fraction < 0) {
+                seconds--;
+                fraction += 1000000;
+            }
+            if (seconds != cached_second_ || cached_length_ == 0) {
+                std::time_t time{static_cast<std::time_t>(seconds)};
+                std::tm tm{};
+                gmtime_r(&time, &tm);
+                cached_length_ = std::strftime(cached_text_.data(), cached_text_.size(), "%Y-%m-%dT%H:%M:%S", &tm);
+                cached_second_ = seconds;
+            }
+            Append_({cached_text_.data(), cached_length_});
+            fmt::format_to(std::back_inserter(line_buffer_), ".{:06}Z", fraction);
+        }
+
+        static constexpr std::array<std::string_view, 8> kReservedKeys{"time", "level", "thread", "file", "line", "function", "message", "fields_error"};
+        static constexpr std::array<std::string_view, kLevelsCount> kLevelNames{"Debug", "Trace", "Info", "Warning", "Error", "Critical", "Off"};
+        int64_t cached_second_{0};
+        size_t cached_length_{0};
+        std::array<char, 32> cached_text_{};
+    };
+}  // namespace adsvel::log
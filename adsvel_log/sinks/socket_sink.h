@@ -0,0 +1,274 @@
+/**
+***************************************************************************************************************************************************************
+* @file     socket_sink.h
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     18.10.2026 02:37:15
+* @brief    Sink streaming records to a local collector over a Unix domain socket or TCP.
+* @details  Every record is sent as one frame: a 4 byte big-endian payload length followed by the line in the FileSink layout without the
+*           trailing '\n' (structured fields included). Frames are collected in a bounded spool and sent by Flush() with non-blocking send(), so
+*           a slow or absent collector never stalls the logger thread. When the spool is full the oldest frames are dropped, a quarter of the
+*           spool at a time. A frame is never split across connections: after a reconnect the frame that was being sent is sent again from its
+*           start, the collector drops the truncated one with the old connection.
+*           The connection is opened without blocking and retried with a backoff from kMinReconnectDelay up to kMaxReconnectDelay.
+*           Optionally the records logged while there is no connection go to a fallback sink (usually a FileSink) instead of the spool.
+*           Endpoints: "unix:/path/to/socket" or "tcp:ADDRESS:PORT" with a numeric IPv4/IPv6 address or "localhost", there is no DNS lookup
+*           on the logger thread. POSIX only.
+***************************************************************************************************************************************************************
+*/
+#pragma once
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "../adsvel_log.h"
+#include "../details/crash_writer.h"
+namespace adsvel::log {
+    class SocketSink : public BaseSink {
+       public:
+        SocketSink(LogLevels in_log_level, const std::string& in_endpoint, size_t in_spool_size = kDefaultSpoolSize, std::unique_ptr<BaseSink> in_fallback = nullptr)
+            : log_level_{in_log_level}, spool_size_{std::max<size_t>(in_spool_size, kFrameHeaderSize + 1)}, fallback_{std::move(in_fallback)} {
+            ParseEndpoint_(in_endpoint);
+            spool_.reserve(std::min(spool_size_, kInitialSpoolReserve));
+        }
+        ~SocketSink() override {
+            Flush();
+            Close_();
+        }
+        LogLevels GetLevel() override final { return fallback_ != nullptr ? std::min(log_level_.load(std::memory_order_relaxed), fallback_->GetLevel()) : log_level_.load(std::memory_order_relaxed); }
+        void SetLevel(LogLevels in_level) override final { log_level_.store(in_level, std::memory_order_relaxed); }
+        void SetTimestampPrecision(TimestampPrecision in_precision) { timestamp_formatter_.SetPrecision(in_precision); }
+        bool IsConnected() const { return state_ == State::Connected; }
+        /// Bytes of frames waiting to be sent.
+        size_t GetSpooledSize() const { return spool_.size() - spool_offset_; }
+
+        void Log(const LogMessage& in_msg) override final { LogBatch({&in_msg, 1}); }
+        void LogBatch(details::Span<const LogMessage> in_msgs) override final {
+            if (state_ != State::Connected && fallback_ != nullptr) {
+                fallback_->LogBatch(in_msgs);
+                return;
+            }
+            auto level{log_level_.load(std::memory_order_relaxed)};
+            for (auto& msg : in_msgs) {
+                if (level <= msg.level) Spool_(msg);
+            }
+        }
+        void Flush() override try {
+            if (state_ != State::Connected) Connect_();
+            if (state_ == State::Connected) Send_();
+            if (fallback_ != nullptr) fallback_->Flush();
+        } catch (...) {  // Don't remove this catch!
+        }
+        /// Frames still in the spool go to the collector if it is connected, otherwise as lines to in_crash_fd.
+        void FlushOnCrash(int in_crash_fd) noexcept override final {
+            if (state_ == State::Connected && fd_ >= 0) {
+                size_t begin{spool_offset_ + sent_in_frame_};
+                while (begin < spool_.size()) {
+                    auto sent{::send(fd_, spool_.data() + begin, spool_.size() - begin, MSG_NOSIGNAL)};
+                    if (sent <= 0 && errno == EINTR) continue;
+                    if (sent <= 0) break;
+                    begin += static_cast<size_t>(sent);
+                }
+                if (begin == spool_.size()) spool_offset_ = spool_.size();
+            }
+            for (size_t pos{spool_offset_}; pos + kFrameHeaderSize <= spool_.size();) {
+                auto length{FrameLength_(pos)};
+                if (pos + kFrameHeaderSize + length > spool_.size()) break;
+                details::WriteAll(in_crash_fd, spool_.data() + pos + kFrameHeaderSize, length);
+                details::WriteAll(in_crash_fd, "\n", 1);
+                pos += kFrameHeaderSize + length;
+            }
+            if (fallback_ != nullptr) fallback_->FlushOnCrash(in_crash_fd);
+        }
+
+        static constexpr size_t kDefaultSpoolSize{16 * 1024 * 1024};
+        static constexpr size_t kFrameHeaderSize{4};
+        static constexpr std::chrono::milliseconds kMinReconnectDelay{100};
+        static constexpr std::chrono::milliseconds kMaxReconnectDelay{std::chrono::seconds(30)};  ///< Same as kPeriodBetweenAttemptsOpenLogFile of FileSink.
+
+       private:
+        enum class State : uint8_t { Disconnected, Connecting, Connected };
+
+        void ParseEndpoint_(const std::string& in_endpoint) {
+            constexpr std::string_view kUnix{"unix:"};
+            constexpr std::string_view kTcp{"tcp:"};
+            std::memset(&address_, 0, sizeof(address_));
+            if (in_endpoint.compare(0, kUnix.size(), kUnix) == 0) {
+                auto path{in_endpoint.substr(kUnix.size())};
+                auto& address{reinterpret_cast<sockaddr_un&>(address_)};
+                if (path.empty() || path.size() >= sizeof(address.sun_path)) throw std::invalid_argument("SocketSink: bad unix socket path in '" + in_endpoint + "'.");
+                address.sun_family = AF_UNIX;
+                std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+                address_size_ = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + 1);
+                return;
+            }
+            if (in_endpoint.compare(0, kTcp.size(), kTcp) == 0) {
+                auto host_port{in_endpoint.substr(kTcp.size())};
+                auto colon{host_port.rfind(':')};
+                if (colon == std::string::npos || colon + 1 == host_port.size()) throw std::invalid_argument("SocketSink: no port in '" + in_endpoint + "'.");
+                auto host{host_port.substr(0, colon)};
+                if (host.size() > 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+                if (host == "localhost") host = "127.0.0.1";
+                auto port{static_cast<uint16_t>(std::stoul(host_port.substr(colon + 1)))};
+                auto& v4{reinterpret_cast<sockaddr_in&>(address_)};
+                auto& v6{reinterpret_cast<sockaddr_in6&>(address_)};
+                if (inet_pton(AF_INET, host.c_str(), &v4.sin_addr) == 1) {
+                    v4.sin_family = AF_INET;
+                    v4.sin_port = htons(port);
+                    address_size_ = sizeof(sockaddr_in);
+                } else if (inet_pton(AF_INET6, host.c_str(), &v6.sin6_addr) == 1) {
+                    v6.sin6_family = AF_INET6;
+                    v6.sin6_port = htons(port);
+                    address_size_ = sizeof(sockaddr_in6);
+                } else {
+                    throw std::invalid_argument("SocketSink: '" + host + "' is not a numeric address.");
+                }
+                return;
+            }
+            throw std::invalid_argument("SocketSink: the endpoint '" + in_endpoint + "' must start with unix: or tcp:.");
+        }
+
+        void Spool_(const LogMessage& in_msg) {
+            line_buffer_.clear();
+            line_buffer_.resize(kFrameHeaderSize);
+            fmt::format_to(std::back_inserter(line_buffer_), "[{0}][{1:6}] {2}", timestamp_formatter_.Format(in_msg.time), LogLevelsStr.at(static_cast<uint16_t>(in_msg.level)), in_msg.message);
+            details::AppendFieldsText(line_buffer_, in_msg.fields);
+            auto length{static_cast<uint32_t>(line_buffer_.size() - kFrameHeaderSize)};
+            for (size_t i{0}; i < kFrameHeaderSize; i++) line_buffer_[i] = static_cast<char>(length >> (8 * (kFrameHeaderSize - 1 - i)));
+            if (line_buffer_.size() > spool_size_) {
+                details::BumpCounter(io_counters_.dropped);
+                return;
+            }
+            if (spool_.size() - spool_offset_ + line_buffer_.size() > spool_size_) {
+                DropOldest_(line_buffer_.size());
+                // The frame being sent is kept, the new one may still not fit next to it.
+                if (spool_.size() - spool_offset_ + line_buffer_.size() > spool_size_) {
+                    details::BumpCounter(io_counters_.dropped);
+                    return;
+                }
+            }
+            if (spool_offset_ != 0 && spool_.size() + line_buffer_.size() > spool_.capacity()) Compact_();
+            spool_.append(line_buffer_.data(), line_buffer_.size());
+        }
+        /// Frees at least in_needed bytes and a quarter of the spool, so a storm doesn't pay for a memmove per record.
+        /// The frame being sent stays: it can't be cut in the middle.
+        void DropOldest_(size_t in_needed) {
+            size_t begin{spool_offset_};
+            if (sent_in_frame_ != 0) begin += kFrameHeaderSize + FrameLength_(begin);
+            size_t target{std::max(in_needed, spool_size_ / 4)};
+            size_t end{begin};
+            uint64_t frames{0};
+            while (end < spool_.size() && end - begin < target) {
+                end += kFrameHeaderSize + FrameLength_(end);
+                frames++;
+            }
+            spool_.erase(begin, end - begin);
+            details::BumpCounter(io_counters_.dropped, frames);
+        }
+        void Compact_() {
+            spool_.erase(0, spool_offset_);
+            spool_offset_ = 0;
+        }
+        uint32_t FrameLength_(size_t in_pos) const {
+            uint32_t length{0};
+            for (size_t i{0}; i < kFrameHeaderSize; i++) length = (length << 8) | static_cast<unsigned char>(spool_[in_pos + i]);
+            return length;
+        }
+
+        /// Starts a connection or checks the one in progress, never waits.
+        void Connect_() {
+            auto now{std::chrono::steady_clock::now()};
+            if (state_ == State::Disconnected) {
+                if (now < next_attempt_) return;
+                details::BumpCounter(io_counters_.open_attempts);
+                fd_ = ::socket(address_.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (fd_ < 0) return Backoff_();
+                if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address_), address_size_) == 0) return Connected_();
+                // EAGAIN from a unix socket means the backlog of the collector is full, nothing is pending, it is retried after the backoff.
+                if (errno != EINPROGRESS) return Backoff_();
+                state_ = State::Connecting;
+                connect_deadline_ = now + kMaxReconnectDelay;
+                return;
+            }
+            int error{0};
+            socklen_t size{sizeof(error)};
+            if (::getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &size) != 0) error = errno;
+            if (error != 0) return Backoff_();
+            sockaddr_storage peer{};
+            socklen_t peer_size{sizeof(peer)};
+            if (::getpeername(fd_, reinterpret_cast<sockaddr*>(&peer), &peer_size) == 0) return Connected_();
+            if (now >= connect_deadline_) Backoff_();  // Still in progress.
+        }
+        void Connected_() {
+            state_ = State::Connected;
+            reconnect_delay_ = kMinReconnectDelay;
+            sent_in_frame_ = 0;
+            if (address_.ss_family != AF_UNIX) {
+                int one{1};
+                ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));  // Frames are already batched per flush.
+            }
+        }
+        void Backoff_() {
+            Close_();
+            next_attempt_ = std::chrono::steady_clock::now() + reconnect_delay_;
+            reconnect_delay_ = std::min(reconnect_delay_ * 2, kMaxReconnectDelay);
+        }
+        void Close_() {
+            if (fd_ >= 0) ::close(fd_);
+            fd_ = -1;
+            state_ = State::Disconnected;
+            sent_in_frame_ = 0;  // The frame is sent again from its start on the next connection.
+        }
+
+        void Send_() {
+            while (spool_offset_ + sent_in_frame_ < spool_.size()) {
+                size_t begin{spool_offset_ + sent_in_frame_};
+                auto sent{::send(fd_, spool_.data() + begin, spool_.size() - begin, MSG_NOSIGNAL | MSG_DONTWAIT)};
+                if (sent < 0) {
+                    if (errno == EINTR) continue;
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) Backoff_();
+                    return;
+                }
+                details::BumpCounter(io_counters_.bytes_written, static_cast<uint64_t>(sent));
+                size_t cursor{begin + static_cast<size_t>(sent)};
+                while (spool_offset_ + kFrameHeaderSize <= cursor) {
+                    size_t frame_end{spool_offset_ + kFrameHeaderSize + FrameLength_(spool_offset_)};
+                    if (frame_end > cursor) break;
+                    spool_offset_ = frame_end;
+                }
+                sent_in_frame_ = cursor - spool_offset_;
+            }
+            spool_.clear();
+            spool_offset_ = 0;
+        }
+
+        static constexpr size_t kInitialSpoolReserve{256 * 1024};
+        std::atomic<LogLevels> log_level_{LogLevels::Info};  ///< Changed from any thread, read by the one writing the sink.
+        size_t spool_size_;
+        std::unique_ptr<BaseSink> fallback_;
+        sockaddr_storage address_{};
+        socklen_t address_size_{0};
+        int fd_{-1};
+        State state_{State::Disconnected};
+        std::chrono::steady_clock::time_point next_attempt_{};
+        std::chrono::steady_clock::time_point connect_deadline_{};
+        std::chrono::milliseconds reconnect_delay_{kMinReconnectDelay};
+        std::string spool_{};      ///< Frames, the unsent ones start at spool_offset_.
+        size_t spool_offset_{0};
+        size_t sent_in_frame_{0};  ///< Bytes of the frame at spool_offset_ already sent on the current connection.
+        details::TimestampFormatter timestamp_formatter_{};
+        fmt::memory_buffer line_buffer_;  ///< The frame being built, reused for every record.
+    };
+}  // namespace adsvel::log
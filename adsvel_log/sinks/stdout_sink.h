@@ -11,38 +11,49 @@
 #pragma once
 
 #include <atomic>
-#include <iomanip>
 #include <iostream>
 #include "../adsvel_log.h"
 namespace adsvel::log {
     class StdoutSink : public BaseSink {
        public:
         StdoutSink(LogLevels in_log_level) : log_level_{in_log_level} {}
-        LogLevels GetLevel() override final { return log_level_; }
-        void SetLevel(LogLevels in_level) override final { log_level_ = in_level; }
+        LogLevels GetLevel() override final { return log_level_.load(std::memory_order_relaxed); }
+        void SetLevel(LogLevels in_level) override final { log_level_.store(in_level, std::memory_order_relaxed); }
+        void SetTimestampPrecision(TimestampPrecision in_precision) { timestamp_formatter_.SetPrecision(in_precision); }
 
         void Log(const LogMessage& in_msg) override {
-            if (log_level_ <= in_msg.level) {
-                std::time_t time = std::chrono::system_clock::to_time_t(in_msg.time);
-                std::tm timetm{};
-#ifdef __GNUC__
-                localtime_r(&time, &timetm);
-#else
-                localtime_s(&timetm, &time);
-#endif
-                char date_time_format[] = "%Y.%m.%d %H:%M:%S";
-                char time_str[] = "yyyy.mm.dd HH:MM:SS.mmm---";
-                strftime(time_str, strlen(time_str), date_time_format, &timetm);
-                std::cout << colors_.at(static_cast<uint16_t>(in_msg.level)) << "[" << time_str << "." << std::setfill('0') << std::setw(3) << std::chrono::duration_cast<std::chrono::milliseconds>(in_msg.time.time_since_epoch()).count() % 1000 << "][" << LogLevelsStr.at(static_cast<uint16_t>(in_msg.level))
-                          << "]\x1b[0m " << in_msg.message << std::endl;
+            if (log_level_.load(std::memory_order_relaxed) <= in_msg.level) {
+                buffer_.clear();
+                FormatLine_(in_msg);
+                std::cout.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size())) << std::flush;
+                details::BumpCounter(io_counters_.bytes_written, buffer_.size());
             }
         }
+        /// All lines of the batch are formatted into one buffer and written with a single call.
+        void LogBatch(details::Span<const LogMessage> in_msgs) override {
+            buffer_.clear();
+            auto level{log_level_.load(std::memory_order_relaxed)};
+            for (auto& msg : in_msgs) {
+                if (level <= msg.level) FormatLine_(msg);
+            }
+            if (buffer_.size() == 0) return;
+            std::cout.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            details::BumpCounter(io_counters_.bytes_written, buffer_.size());
+        }
         void Flush() override { std::cout << std::flush; }
 
        private:
+        void FormatLine_(const LogMessage& in_msg) {
+            fmt::format_to(std::back_inserter(buffer_), "{}[{}][{}]\x1b[0m {}", colors_.at(static_cast<uint16_t>(in_msg.level)), timestamp_formatter_.Format(in_msg.time), LogLevelsStr.at(static_cast<uint16_t>(in_msg.level)), in_msg.message);
+            details::AppendFieldsText(buffer_, in_msg.fields);
+            buffer_.push_back('\n');
+        }
+
+        details::TimestampFormatter timestamp_formatter_{};
+        fmt::memory_buffer buffer_;
         std::string message_pattern_{""};
         constexpr static std::array<std::string_view, static_cast<size_t>(LogLevels::_EnumEndDontUseThis_)> colors_{"\x1b[37m", "\x1b[37m", "\x1b[36m", "\x1b[33m", "\x1b[31m", "\x1b[31m", ""};
-        LogLevels log_level_{LogLevels::Info};
+        std::atomic<LogLevels> log_level_{LogLevels::Info};  ///< Changed from any thread, read by the one writing the sink.
     };
 
 }  // namespace adsvel::log
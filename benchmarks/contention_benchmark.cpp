@@ -0,0 +1,89 @@
+/**
+***************************************************************************************************************************************************************
+* @file     contention_benchmark.cpp
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 10:40:15
+* @brief    Per-call latency of Logger::Log under contention.
+* @details  Usage: contention_benchmark [block|drop|overwrite] [calls_per_thread] [eager|deferred]
+*           Prints p50/p99/p999 latency of a single Logger::Log call (FMT_COMPILE format) for 1 to 64 producer threads.
+***************************************************************************************************************************************************************
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "adsvel_log/adsvel_log.h"
+
+namespace {
+    using adsvel::log::LogLevels;
+    using adsvel::log::Logger;
+    using adsvel::log::QueueFullPolicy;
+
+    class NullSink : public adsvel::log::BaseSink {
+       public:
+        LogLevels GetLevel() override final { return LogLevels::Info; }
+        void SetLevel(LogLevels) override final {}
+        void Log(const adsvel::log::LogMessage& in_msg) override final { bytes_ += in_msg.message.size(); }
+        void Flush() override final {}
+
+       private:
+        size_t bytes_{0};
+    };
+
+    QueueFullPolicy ParsePolicy(std::string_view in_name) {
+        if (in_name == "drop") return QueueFullPolicy::DropNewest;
+        if (in_name == "overwrite") return QueueFullPolicy::OverwriteOldest;
+        return QueueFullPolicy::Block;
+    }
+
+    int64_t Percentile(const std::vector<int64_t>& in_sorted, double in_fraction) {
+        if (in_sorted.empty()) return 0;
+        auto index{static_cast<size_t>(in_fraction * static_cast<double>(in_sorted.size() - 1))};
+        return in_sorted[index];
+    }
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string_view policy_name{argc > 1 ? argv[1] : "block"};
+    size_t calls_per_thread{argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000};
+    bool deferred{argc > 3 && std::string_view{argv[3]} == "deferred"};
+
+    Logger::SetLogInterval(std::chrono::milliseconds(1));
+    Logger::SetDeferredFormatting(deferred);
+    Logger::Initialize(ParsePolicy(policy_name));
+    Logger::AddSink(std::make_unique<NullSink>());
+
+    std::cout << "policy: " << policy_name << ", calls per thread: " << calls_per_thread << ", formatting: " << (deferred ? "deferred" : "eager") << "\n";
+    std::cout << "threads\tp50 ns\tp99 ns\tp999 ns\tmax ns\tdropped\n";
+    for (size_t threads_count : {1, 2, 4, 8, 16, 32, 64}) {
+        std::vector<std::vector<int64_t>> latencies(threads_count);
+        std::vector<std::thread> threads;
+        auto dropped_before{Logger::GetDroppedMessagesCount()};
+        for (size_t t{0}; t < threads_count; t++) {
+            threads.emplace_back([&latencies, t, calls_per_thread]() {
+                auto& lat{latencies[t]};
+                lat.reserve(calls_per_thread);
+                for (size_t i{0}; i < calls_per_thread; i++) {
+                    auto begin{std::chrono::steady_clock::now()};
+                    Logger::Log(LogLevels::Info, FMT_COMPILE("Request {} from worker {} done"), i, t);
+                    auto end{std::chrono::steady_clock::now()};
+                    lat.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+
+        std::vector<int64_t> all;
+        all.reserve(threads_count * calls_per_thread);
+        for (auto& lat : latencies) all.insert(all.end(), lat.begin(), lat.end());
+        std::sort(all.begin(), all.end());
+        std::cout << threads_count << "\t" << Percentile(all, 0.5) << "\t" << Percentile(all, 0.99) << "\t" << Percentile(all, 0.999) << "\t" << (all.empty() ? 0 : all.back()) << "\t"
+                  << Logger::GetDroppedMessagesCount() - dropped_before << std::endl;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));  // Let the logger thread drain the queue before the next round.
+    }
+    return 0;
+}
@@ -0,0 +1,258 @@
+/**
+***************************************************************************************************************************************************************
+* @file     logger_benchmark.cpp
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 21:52:09
+* @brief    google-benchmark suite of the logger.
+* @details  - BM_LogLatency/BM_LogLatencyFiltered: Logger::Log call latency (FMT_COMPILE format) with the level enabled and filtered out, 1 to 8 threads, eager and
+*             deferred formatting. Every call is timed and put into a histogram, p50/p99/p999/max are reported as counters in ns.
+*           - BM_FileSinkThroughput/BM_StdoutSinkThroughput: end-to-end messages per second, from the first Log() until the logger has
+*             written and flushed everything. The StdoutSink run points file descriptor 1 at /dev/null for the duration of the benchmark.
+*           - BM_FileSinkRotation: the same with 1 MB files, so the sink rotates every ~12000 messages; compressed too when zstd is available.
+*           - BM_FileSinkOutage: resident memory growth of a FileSink whose directory doesn't exist, after N MB of logs.
+*           Results are machine-readable with the usual google-benchmark flags, e.g.
+*               logger_benchmark --benchmark_format=json --benchmark_out=results.json
+***************************************************************************************************************************************************************
+*/
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "adsvel_log/adsvel_log.h"
+#include "adsvel_log/sinks/file_sink.h"
+#include "adsvel_log/sinks/stdout_sink.h"
+
+namespace {
+    using adsvel::log::BaseSink;
+    using adsvel::log::FileCompression;
+    using adsvel::log::FileSink;
+    using adsvel::log::Logger;
+    using adsvel::log::LogLevels;
+    using adsvel::log::LogMessage;
+
+    /// Logger sinks can't be removed, so a single sink is added once and forwards to the sink of the running benchmark. The target is only
+    /// replaced while the logger is shut down.
+    class SwitchSink : public BaseSink {
+       public:
+        LogLevels GetLevel() override final { return LogLevels::Info; }
+        void SetLevel(LogLevels) override final {}
+        void Log(const LogMessage& in_msg) override final {
+            if (target_ != nullptr) target_->Log(in_msg);
+        }
+        void LogBatch(adsvel::log::details::Span<const LogMessage> in_msgs) override final {
+            if (target_ != nullptr) target_->LogBatch(in_msgs);
+        }
+        void Flush() override final {
+            if (target_ != nullptr) target_->Flush();
+        }
+        void SetTarget(std::unique_ptr<BaseSink> in_target) { target_ = std::move(in_target); }
+
+       private:
+        std::unique_ptr<BaseSink> target_{};
+    };
+
+    class NullSink : public BaseSink {
+       public:
+        LogLevels GetLevel() override final { return LogLevels::Info; }
+        void SetLevel(LogLevels) override final {}
+        void Log(const LogMessage& in_msg) override final { benchmark::DoNotOptimize(in_msg.message.size()); }
+        void Flush() override final {}
+    };
+
+    SwitchSink* switch_sink{nullptr};
+
+    /// Stops the logger, so the previous benchmark's messages are drained, and starts it again with in_target.
+    void RestartLogger(std::unique_ptr<BaseSink> in_target) {
+        Logger::Shutdown();
+        if (switch_sink == nullptr) {
+            auto sink{std::make_unique<SwitchSink>()};
+            switch_sink = sink.get();
+            Logger::AddSink(std::move(sink));
+        }
+        switch_sink->SetTarget(std::move(in_target));
+        Logger::SetLogInterval(std::chrono::milliseconds(1));
+        Logger::Initialize();
+    }
+
+    /// Log-linear histogram: 16 sub-buckets per power of two, so a percentile is accurate to ~6%.
+    class LatencyHistogram {
+       public:
+        void Add(uint64_t in_ns) {
+            counts_[Bucket_(in_ns)]++;
+            total_++;
+            max_ = std::max(max_, in_ns);
+        }
+        uint64_t Percentile(double in_fraction) const {
+            auto rank{static_cast<uint64_t>(in_fraction * static_cast<double>(total_))};
+            uint64_t seen{0};
+            for (size_t i{0}; i < counts_.size(); i++) {
+                seen += counts_[i];
+                if (seen > rank) return std::min(UpperBound_(i), max_);
+            }
+            return max_;
+        }
+        uint64_t Max() const { return max_; }
+
+       private:
+        static constexpr size_t kSubBuckets{16};
+        static size_t Bucket_(uint64_t in_ns) {
+            if (in_ns < kSubBuckets) return in_ns;
+            size_t exponent{static_cast<size_t>(63 - __builtin_clzll(in_ns))};  // >= 4
+            size_t sub{static_cast<size_t>(in_ns >> (exponent - 4)) & (kSubBuckets - 1)};
+            return (exponent - 3) * kSubBuckets + sub;
+        }
+        static uint64_t UpperBound_(size_t in_bucket) {
+            if (in_bucket < kSubBuckets) return in_bucket;
+            size_t exponent{in_bucket / kSubBuckets + 3};
+            uint64_t sub{in_bucket % kSubBuckets};
+            return ((kSubBuckets + sub + 1) << (exponent - 4)) - 1;
+        }
+
+        std::array<uint64_t, 61 * kSubBuckets> counts_{};
+        uint64_t total_{0};
+        uint64_t max_{0};
+    };
+
+    void ReportLatency(benchmark::State& state, const LatencyHistogram& in_histogram) {
+        // Every thread reports its own percentiles, google-benchmark averages them over the threads.
+        state.counters["p50_ns"] = benchmark::Counter(static_cast<double>(in_histogram.Percentile(0.50)), benchmark::Counter::kAvgThreads);
+        state.counters["p99_ns"] = benchmark::Counter(static_cast<double>(in_histogram.Percentile(0.99)), benchmark::Counter::kAvgThreads);
+        state.counters["p999_ns"] = benchmark::Counter(static_cast<double>(in_histogram.Percentile(0.999)), benchmark::Counter::kAvgThreads);
+        state.counters["max_ns"] = benchmark::Counter(static_cast<double>(in_histogram.Max()), benchmark::Counter::kAvgThreads);
+    }
+
+    template <LogLevels kLevel>
+    void LogLatency(benchmark::State& state) {
+        if (state.thread_index() == 0) {
+            Logger::SetDeferredFormatting(state.range(0) != 0);
+            RestartLogger(std::make_unique<NullSink>());
+        }
+        LatencyHistogram histogram;
+        uint64_t i{0};
+        for (auto _ : state) {
+            auto begin{std::chrono::steady_clock::now()};
+            Logger::Log(kLevel, FMT_COMPILE("Request {} done in {} us, status {}"), i, 3.25, "ok");
+            auto end{std::chrono::steady_clock::now()};
+            histogram.Add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()));
+            i++;
+        }
+        ReportLatency(state, histogram);
+        state.SetItemsProcessed(state.iterations());
+    }
+    void BM_LogLatency(benchmark::State& state) { LogLatency<LogLevels::Info>(state); }
+    void BM_LogLatencyFiltered(benchmark::State& state) { LogLatency<LogLevels::Debug>(state); }
+
+    /// One iteration logs kMessages lines and waits until the sink has written and flushed all of them.
+    void Throughput(benchmark::State& state, const std::function<std::unique_ptr<BaseSink>()>& in_make_sink) {
+        constexpr size_t kMessages{100000};
+        Logger::SetDeferredFormatting(state.range(0) != 0);
+        RestartLogger(in_make_sink());
+        size_t bytes{0};
+        for (auto _ : state) {
+            for (size_t i{0}; i < kMessages; i++) Logger::Log(LogLevels::Info, FMT_COMPILE("Request {} done in {} us, status {}"), i, 3.25, "ok");
+            Logger::Shutdown();
+            state.PauseTiming();
+            Logger::Initialize();
+            state.ResumeTiming();
+            bytes += kMessages * 70;  // Approximate line length with the timestamp.
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kMessages));
+        state.SetBytesProcessed(static_cast<int64_t>(bytes));
+        RestartLogger(nullptr);
+    }
+
+    std::filesystem::path FreshDirectory(const std::string& in_name) {
+        auto dir{std::filesystem::temp_directory_path() / "adsvel_logger_benchmark" / in_name};
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    void BM_FileSinkThroughput(benchmark::State& state) {
+        auto dir{FreshDirectory("throughput")};
+        Throughput(state, [&]() { return std::make_unique<FileSink>(LogLevels::Info, (dir / "LOG {}.txt").string(), 64, 4); });
+        std::filesystem::remove_all(dir);
+    }
+
+    void BM_StdoutSinkThroughput(benchmark::State& state) {
+        std::cout.flush();
+        std::fflush(stdout);
+        int saved_stdout{dup(STDOUT_FILENO)};
+        int dev_null{open("/dev/null", O_WRONLY)};
+        dup2(dev_null, STDOUT_FILENO);
+        Throughput(state, []() { return std::make_unique<adsvel::log::StdoutSink>(LogLevels::Info); });
+        std::cout.flush();
+        std::fflush(stdout);
+        dup2(saved_stdout, STDOUT_FILENO);
+        close(dev_null);
+        close(saved_stdout);
+    }
+
+    void BM_FileSinkRotation(benchmark::State& state) {
+        auto dir{FreshDirectory("rotation")};
+        auto compression{state.range(1) != 0 ? FileCompression::Zstd : FileCompression::None};
+        if (compression == FileCompression::Zstd && !adsvel::log::details::kZstdAvailable) {
+            state.SkipWithError("adsvel_log is built without zstd");
+            return;
+        }
+        Throughput(state, [&]() { return std::make_unique<FileSink>(LogLevels::Info, (dir / "LOG {}.txt").string(), 1, 8, compression); });
+        std::filesystem::remove_all(dir);
+    }
+
+    size_t ResidentBytes() {
+        std::ifstream statm("/proc/self/statm");
+        size_t pages{0};
+        size_t resident{0};
+        statm >> pages >> resident;
+        return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    /// The sink is driven directly, so the result shows only the sink's own buffering. range(0) is the amount of logs in MB.
+    void BM_FileSinkOutage(benchmark::State& state) {
+        auto missing{std::filesystem::temp_directory_path() / "adsvel_logger_benchmark" / "missing" / "LOG {}.txt"};
+        std::filesystem::remove_all(missing.parent_path());
+        std::vector<LogMessage> batch;
+        for (size_t i{0}; i < 1000; i++) batch.emplace_back(LogLevels::Info, fmt::format("Request {} done in {} us, status {:>32}", i, i * 7 % 1000, "ok"));
+        size_t batches{static_cast<size_t>(state.range(0)) * 1024 * 1024 / (batch.size() * 90)};
+
+        double growth{0};
+        double dropped{0};
+        for (auto _ : state) {
+            state.PauseTiming();
+            auto sink{std::make_unique<FileSink>(LogLevels::Info, missing.string(), 16, 4)};
+            auto before{ResidentBytes()};
+            state.ResumeTiming();
+            for (size_t b{0}; b < batches; b++) {
+                sink->LogBatch(batch);
+                sink->Flush();
+            }
+            state.PauseTiming();
+            growth = static_cast<double>(ResidentBytes()) - static_cast<double>(before);
+            dropped = static_cast<double>(sink->GetDroppedLinesCount());
+            sink.reset();
+            state.ResumeTiming();
+        }
+        state.counters["rss_growth_mb"] = growth / (1024 * 1024);
+        state.counters["dropped_lines"] = dropped;
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batches * batch.size()));
+    }
+}  // namespace
+
+BENCHMARK(BM_LogLatency)->ArgName("deferred")->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_LogLatencyFiltered)->ArgName("deferred")->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_FileSinkThroughput)->ArgName("deferred")->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StdoutSinkThroughput)->ArgName("deferred")->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FileSinkRotation)->ArgNames({"deferred", "zstd"})->Args({0, 0})->Args({1, 0})->Args({1, 1})->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FileSinkOutage)->ArgName("mb")->Arg(16)->Arg(64)->Arg(256)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,80 @@
+/**
+***************************************************************************************************************************************************************
+* @file     sinks_benchmark.cpp
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 14:52:48
+* @brief    Throughput of per-message Log() against LogBatch() for 1, 4 and 16 sinks.
+* @details  Usage: sinks_benchmark [messages_per_batch] [batches]
+*           Every sink is a FileSink writing to its own file in a temporary directory.
+***************************************************************************************************************************************************************
+*/
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "adsvel_log/adsvel_log.h"
+#include "adsvel_log/sinks/file_sink.h"
+
+namespace {
+    using adsvel::log::BaseSink;
+    using adsvel::log::FileSink;
+    using adsvel::log::LogLevels;
+    using adsvel::log::LogMessage;
+
+    std::vector<std::unique_ptr<BaseSink>> MakeSinks(const std::filesystem::path& in_dir, size_t in_count) {
+        std::vector<std::unique_ptr<BaseSink>> sinks;
+        for (size_t i{0}; i < in_count; i++) {
+            sinks.push_back(std::make_unique<FileSink>(LogLevels::Info, fmt::format("{}/sink{}_LOG {{}}.txt", in_dir.string(), i), 64, 2));
+        }
+        return sinks;
+    }
+
+    template <class Fn>
+    double MessagesPerSecond(size_t in_messages, Fn&& in_fn) {
+        auto begin{std::chrono::steady_clock::now()};
+        in_fn();
+        std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - begin};
+        return static_cast<double>(in_messages) / elapsed.count();
+    }
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t messages_per_batch{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000};
+    size_t batches{argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20};
+
+    std::vector<LogMessage> batch;
+    for (size_t i{0}; i < messages_per_batch; i++) {
+        batch.emplace_back(i % 4 == 0 ? LogLevels::Debug : LogLevels::Info, fmt::format("Request {} done in {} us", i, i * 7 % 1000));
+    }
+
+    auto dir{std::filesystem::temp_directory_path() / "adsvel_sinks_benchmark"};
+    std::cout << "sinks\tper-message msg/s\tbatch msg/s\n";
+    for (size_t sinks_count : {1, 4, 16}) {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir / "per_message");
+        std::filesystem::create_directories(dir / "batch");
+        auto per_message_sinks{MakeSinks(dir / "per_message", sinks_count)};
+        auto batch_sinks{MakeSinks(dir / "batch", sinks_count)};
+
+        double per_message{MessagesPerSecond(messages_per_batch * batches, [&]() {
+            for (size_t b{0}; b < batches; b++) {
+                for (auto& msg : batch) {
+                    for (auto& sink : per_message_sinks) sink->Log(msg);
+                }
+                for (auto& sink : per_message_sinks) sink->Flush();
+            }
+        })};
+        double batched{MessagesPerSecond(messages_per_batch * batches, [&]() {
+            for (size_t b{0}; b < batches; b++) {
+                for (auto& sink : batch_sinks) sink->LogBatch(batch);
+                for (auto& sink : batch_sinks) sink->Flush();
+            }
+        })};
+        std::cout << sinks_count << "\t" << static_cast<uint64_t>(per_message) << "\t" << static_cast<uint64_t>(batched) << std::endl;
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -24,8 +24,8 @@ int main() {
         Logger::Trace("Trace");
         Logger::Info("123");
         Logger::Error("567");
-        Logger::Warning("Hello kitty {1} {0}", counter++, 666);
-        Logger::Critical("Critical error {}", true);
+        ADSVEL_LOG_WARNING("Hello kitty {1} {0}", counter++, 666);
+        ADSVEL_LOG_CRITICAL("Critical error {}", true);
     }
     return 0;
 }
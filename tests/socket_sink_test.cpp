@@ -0,0 +1,177 @@
+/**
+***************************************************************************************************************************************************************
+* @file     socket_sink_test.cpp
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 19:40:12
+* @brief    SocketSink against a unix socket listener in the same process.
+* @details  Checks that records arrive as length-prefixed frames, that the sink reconnects and resends its spool after the listener restarts,
+*           and that without a listener the records go to the fallback sink or stay in the bounded spool. Exits with 1 on the first failure.
+***************************************************************************************************************************************************************
+*/
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "adsvel_log/adsvel_log.h"
+#include "adsvel_log/sinks/socket_sink.h"
+
+namespace {
+    using adsvel::log::BaseSink;
+    using adsvel::log::LogLevels;
+    using adsvel::log::LogMessage;
+    using adsvel::log::SocketSink;
+
+    constexpr std::chrono::seconds kTimeout{5};
+
+    void Check(bool in_condition, const char* in_what) {
+        if (in_condition) return;
+        std::fprintf(stderr, "FAILED: %s\n", in_what);
+        std::exit(1);
+    }
+
+    /// Accepts one connection at a time and splits what it reads into frames.
+    class UnixListener {
+       public:
+        explicit UnixListener(std::string in_path) : path_{std::move(in_path)} {}
+        ~UnixListener() { Stop(); }
+
+        void Start() {
+            ::unlink(path_.c_str());
+            listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1);
+            Check(listen_fd_ >= 0 && ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 && ::listen(listen_fd_, 4) == 0, "listener starts");
+        }
+        void Stop() {
+            if (client_fd_ >= 0) ::close(client_fd_);
+            if (listen_fd_ >= 0) ::close(listen_fd_);
+            client_fd_ = listen_fd_ = -1;
+            buffer_.clear();
+            ::unlink(path_.c_str());
+        }
+
+        /// Reads until in_count frames are complete, calling in_flush in between so the sink gets to connect and send.
+        template <class Fn>
+        std::vector<std::string> ReadFrames(size_t in_count, Fn&& in_flush) {
+            std::vector<std::string> frames;
+            auto deadline{std::chrono::steady_clock::now() + kTimeout};
+            while (frames.size() < in_count && std::chrono::steady_clock::now() < deadline) {
+                in_flush();
+                if (client_fd_ < 0) {
+                    pollfd fd{listen_fd_, POLLIN, 0};
+                    if (::poll(&fd, 1, 10) == 1) client_fd_ = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+                    continue;
+                }
+                pollfd fd{client_fd_, POLLIN, 0};
+                if (::poll(&fd, 1, 10) != 1) continue;
+                char chunk[4096];
+                auto size{::read(client_fd_, chunk, sizeof(chunk))};
+                Check(size > 0, "collector connection stays open");
+                buffer_.append(chunk, static_cast<size_t>(size));
+                while (buffer_.size() >= SocketSink::kFrameHeaderSize) {
+                    uint32_t length{0};
+                    for (size_t i{0}; i < SocketSink::kFrameHeaderSize; i++) length = (length << 8) | static_cast<unsigned char>(buffer_[i]);
+                    if (buffer_.size() < SocketSink::kFrameHeaderSize + length) break;
+                    frames.push_back(buffer_.substr(SocketSink::kFrameHeaderSize, length));
+                    buffer_.erase(0, SocketSink::kFrameHeaderSize + length);
+                }
+            }
+            return frames;
+        }
+
+       private:
+        std::string path_;
+        int listen_fd_{-1};
+        int client_fd_{-1};
+        std::string buffer_{};
+    };
+
+    /// Keeps the messages it receives, stands in for the FileSink a SocketSink usually falls back to.
+    class CaptureSink : public BaseSink {
+       public:
+        explicit CaptureSink(std::vector<std::string>& out_messages) : messages_{out_messages} {}
+        LogLevels GetLevel() override final { return LogLevels::Debug; }
+        void SetLevel(LogLevels) override final {}
+        void Log(const LogMessage& in_msg) override final { messages_.push_back(in_msg.message); }
+        void Flush() override final {}
+
+       private:
+        std::vector<std::string>& messages_;
+    };
+
+    std::vector<LogMessage> MakeRecords(const std::string& in_prefix, size_t in_count) {
+        std::vector<LogMessage> records;
+        for (size_t i{0}; i < in_count; i++) records.emplace_back(LogLevels::Info, in_prefix + " " + std::to_string(i));
+        return records;
+    }
+
+    bool EndsWith(const std::string& in_text, const std::string& in_suffix) {
+        return in_text.size() >= in_suffix.size() && in_text.compare(in_text.size() - in_suffix.size(), in_suffix.size(), in_suffix) == 0;
+    }
+
+    void TestFramedDeliveryAndReconnect(const std::string& in_path) {
+        UnixListener listener{in_path};
+        listener.Start();
+        SocketSink sink{LogLevels::Info, "unix:" + in_path};
+        auto first{MakeRecords("first", 3)};
+        first.emplace_back(LogLevels::Debug, "filtered out");
+        sink.LogBatch(first);
+        auto frames{listener.ReadFrames(3, [&]() { sink.Flush(); })};
+        Check(frames.size() == 3, "three frames are delivered");
+        for (size_t i{0}; i < frames.size(); i++) Check(EndsWith(frames[i], "first " + std::to_string(i)), "a frame holds one record");
+        Check(sink.IsConnected() && sink.GetSpooledSize() == 0, "the spool is empty after sending");
+
+        listener.Stop();
+        auto second{MakeRecords("second", 5)};
+        sink.LogBatch(second);
+        sink.Flush();  // Finds the peer gone, the frames stay in the spool.
+        listener.Start();
+        frames = listener.ReadFrames(5, [&]() { sink.Flush(); });
+        Check(frames.size() == 5, "the spool is resent after the listener restarts");
+        for (size_t i{0}; i < frames.size(); i++) Check(EndsWith(frames[i], "second " + std::to_string(i)), "resent frames keep their order");
+        Check(sink.GetIoCounters().open_attempts.load() >= 2, "the sink reconnected");
+    }
+
+    void TestFallbackWithoutListener(const std::string& in_path) {
+        ::unlink(in_path.c_str());
+        std::vector<std::string> captured;
+        SocketSink sink{LogLevels::Info, "unix:" + in_path, SocketSink::kDefaultSpoolSize, std::make_unique<CaptureSink>(captured)};
+        sink.Flush();
+        sink.LogBatch(MakeRecords("fallback", 4));
+        Check(!sink.IsConnected(), "there is nothing to connect to");
+        Check(captured.size() == 4 && captured.back() == "fallback 3", "records go to the fallback sink");
+        Check(sink.GetSpooledSize() == 0, "nothing is spooled while the fallback takes the records");
+    }
+
+    void TestBoundedSpoolWithoutListener(const std::string& in_path) {
+        ::unlink(in_path.c_str());
+        constexpr size_t kSpoolSize{4096};
+        SocketSink sink{LogLevels::Info, "unix:" + in_path, kSpoolSize};
+        sink.Flush();
+        sink.LogBatch(MakeRecords("spooled record with some padding to fill the spool faster", 500));
+        Check(!sink.IsConnected(), "there is nothing to connect to");
+        Check(sink.GetSpooledSize() > 0 && sink.GetSpooledSize() <= kSpoolSize, "the spool keeps records within its size");
+        Check(sink.GetIoCounters().dropped.load() > 0, "records that don't fit are counted as dropped");
+    }
+}  // namespace
+
+int main() {
+    auto path{(std::filesystem::temp_directory_path() / ("adsvel_socket_sink_test_" + std::to_string(::getpid()) + ".sock")).string()};
+    TestFramedDeliveryAndReconnect(path);
+    TestFallbackWithoutListener(path);
+    TestBoundedSpoolWithoutListener(path);
+    ::unlink(path.c_str());
+    std::puts("socket_sink_test: OK");
+    return 0;
+}
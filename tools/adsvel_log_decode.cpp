@@ -0,0 +1,170 @@
+/**
+***************************************************************************************************************************************************************
+* @file     adsvel_log_decode.cpp
+* @author   Kuznetsov A.(RivandBlack).
+* @version  v 0.0.1
+* @date     17.10.2026 20:48:15
+* @brief    Turns BinarySink files back into the FileSink text layout.
+* @details  Usage: adsvel_log_decode [--from TIME] [--to TIME] [--level LEVEL] [--precision ms|us|ns] FILE...
+*           TIME is either seconds since the epoch or local time "yyyy.mm.dd HH:MM:SS". LEVEL is a LogLevelsStr name as printed in the log,
+*           messages below it are skipped. Files are decoded in the order they are given, the output goes to stdout.
+***************************************************************************************************************************************************************
+*/
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "adsvel_log/adsvel_log.h"
+#include "adsvel_log/details/binary_format.h"
+#include "adsvel_log/details/deferred_args.h"
+#include "adsvel_log/details/timestamp_formatter.h"
+
+namespace {
+    using adsvel::log::LogLevels;
+    using adsvel::log::LogLevelsStr;
+    using adsvel::log::details::BinaryReader;
+    using adsvel::log::details::BinaryRecordType;
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    struct Options {
+        std::optional<TimePoint> from{};
+        std::optional<TimePoint> to{};
+        LogLevels level{LogLevels::Debug};
+        adsvel::log::TimestampPrecision precision{adsvel::log::TimestampPrecision::Milliseconds};
+        std::vector<std::string> files{};
+    };
+
+    std::optional<TimePoint> ParseTime(const std::string& in_text) {
+        if (in_text.find_first_not_of("0123456789") == std::string::npos) return TimePoint{std::chrono::seconds(std::stoll(in_text))};
+        std::tm tm{};
+        tm.tm_isdst = -1;
+        if (std::sscanf(in_text.c_str(), "%d.%d.%d %d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6) return std::nullopt;
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+    }
+
+    std::optional<LogLevels> ParseLevel(const std::string& in_text) {
+        for (size_t i{0}; i < LogLevelsStr.size(); i++) {
+            if (LogLevelsStr[i] == in_text) return static_cast<LogLevels>(i);
+        }
+        return std::nullopt;
+    }
+
+    std::optional<Options> ParseOptions(int argc, char** argv) {
+        Options options;
+        for (int i{1}; i < argc; i++) {
+            std::string arg{argv[i]};
+            bool has_value{i + 1 < argc};
+            if (arg == "--from" && has_value) {
+                options.from = ParseTime(argv[++i]);
+                if (!options.from) return std::nullopt;
+            } else if (arg == "--to" && has_value) {
+                options.to = ParseTime(argv[++i]);
+                if (!options.to) return std::nullopt;
+            } else if (arg == "--level" && has_value) {
+                auto level{ParseLevel(argv[++i])};
+                if (!level) return std::nullopt;
+                options.level = *level;
+            } else if (arg == "--precision" && has_value) {
+                std::string precision{argv[++i]};
+                if (precision == "ms") options.precision = adsvel::log::TimestampPrecision::Milliseconds;
+                else if (precision == "us") options.precision = adsvel::log::TimestampPrecision::Microseconds;
+                else if (precision == "ns") options.precision = adsvel::log::TimestampPrecision::Nanoseconds;
+                else return std::nullopt;
+            } else if (arg.rfind("--", 0) == 0) {
+                return std::nullopt;
+            } else {
+                options.files.push_back(arg);
+            }
+        }
+        if (options.files.empty()) return std::nullopt;
+        return options;
+    }
+
+    /// Returns false if the file is not a binary log or is corrupted, everything decoded before the error is already printed.
+    bool DecodeFile(const std::string& in_file, const Options& in_options, fmt::memory_buffer& out_buffer) {
+        std::ifstream stream(in_file, std::ifstream::binary);
+        if (!stream) {
+            std::cerr << "Can't open " << in_file << '\n';
+            return false;
+        }
+        std::string data{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+        if (data.compare(0, adsvel::log::details::kBinaryLogMagic.size(), adsvel::log::details::kBinaryLogMagic) != 0) {
+            std::cerr << in_file << " is not an adsvel_log binary log\n";
+            return false;
+        }
+
+        adsvel::log::details::TimestampFormatter timestamp_formatter{in_options.precision};
+        std::vector<std::string_view> formats;
+        int64_t time_ns{0};
+        BinaryReader reader{std::string_view(data).substr(adsvel::log::details::kBinaryLogMagic.size())};
+        try {
+            while (!reader.AtEnd()) {
+                auto type{static_cast<BinaryRecordType>(reader.Byte())};
+                if (type == BinaryRecordType::FormatDef) {
+                    auto id{reader.Varint()};
+                    auto format{reader.Bytes(reader.Varint())};
+                    if (id >= formats.size()) formats.resize(id + 1);
+                    formats[id] = format;
+                    continue;
+                }
+                if (type != BinaryRecordType::Message) throw std::out_of_range("Unknown record type.");
+                auto id{reader.Varint()};
+                time_ns += adsvel::log::details::ZigZagDecode(reader.Varint());
+                auto level_value{reader.Byte()};
+                auto args{reader.Bytes(reader.Varint())};
+                if (id >= formats.size() || level_value >= LogLevelsStr.size()) throw std::out_of_range("Unknown format id or level.");
+
+                TimePoint time{std::chrono::duration_cast<TimePoint::duration>(std::chrono::nanoseconds(time_ns))};
+                auto level{static_cast<LogLevels>(level_value)};
+                if (level < in_options.level) continue;
+                if (in_options.from && time < *in_options.from) continue;
+                if (in_options.to && time > *in_options.to) continue;
+
+                fmt::dynamic_format_arg_store<fmt::format_context> store;
+                std::string message;
+                try {
+                    adsvel::log::details::DecodeArgs(reinterpret_cast<const std::byte*>(args.data()), args.size(), store);
+                    message = fmt::vformat(formats[id], store);
+                } catch (const std::exception& e) {
+                    message = fmt::format("Failed to format \"{}\": {}", formats[id], e.what());
+                }
+                fmt::format_to(std::back_inserter(out_buffer), "[{0}][{1:6}] {2}\n", timestamp_formatter.Format(time), LogLevelsStr.at(level_value), message);
+                if (out_buffer.size() > 1024 * 1024) {
+                    std::cout.write(out_buffer.data(), static_cast<std::streamsize>(out_buffer.size()));
+                    out_buffer.clear();
+                }
+            }
+        } catch (const std::out_of_range& e) {
+            std::cerr << in_file << ": " << e.what() << " at offset " << reader.Position() + adsvel::log::details::kBinaryLogMagic.size() << '\n';
+            return false;
+        }
+        return true;
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto options{ParseOptions(argc, argv)};
+    if (!options) {
+        std::cerr << "Usage: adsvel_log_decode [--from TIME] [--to TIME] [--level LEVEL] [--precision ms|us|ns] FILE...\n"
+                     "TIME is seconds since the epoch or local \"yyyy.mm.dd HH:MM:SS\", LEVEL is a level name as printed in the log: Debug, Trace, Info, Warnng, Error, Critic.\n";
+        return 2;
+    }
+    bool ok{true};
+    fmt::memory_buffer buffer;
+    for (auto& file : options->files) {
+        ok = DecodeFile(file, *options, buffer) && ok;
+        std::cout.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+    std::cout.flush();
+    return ok ? 0 : 1;
+}